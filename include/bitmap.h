@@ -21,13 +21,73 @@
 #define __JANERT_PIXELSCALERS_BITMAP__
 
 #include <cstdint>
+#include <fstream>
 #include <string>
+#include <vector>
+
+// Reads a Windows Bitmap image (BMP3, 24 bits) one row at a time, in file
+// order: the file stores the bottom row of the image first. Regular files
+// are mapped into memory; anything else is read as a stream. The file name
+// "-" denotes standard input. Mapped files can also be read in arbitrary
+// order, one span of a row (counted from the top) at a time.
+class BitmapReader {
+ public:
+  BitmapReader();
+  ~BitmapReader();
+  BitmapReader( const BitmapReader & ) = delete;
+  BitmapReader &operator=( const BitmapReader & ) = delete;
+
+  int open( const std::string &fileName );
+  int readRow( uint32_t *row );
+  int readSpan( uint32_t y, uint32_t x, uint32_t count, uint32_t *dst );
+
+  uint32_t width() const { return w; }
+  uint32_t height() const { return h; }
+
+ private:
+  std::ifstream file;
+  std::istream *input;
+  const uint8_t *map, *next;
+  size_t mapSize;
+  std::vector<uint8_t> buffer;
+  size_t rowSize;
+  uint32_t rowsLeft;
+  uint32_t w, h;
+};
+
+// Writes a Windows Bitmap image (BMP3, 24 bits) one row at a time, in file
+// order (bottom row first). Rows are collected into stripes, and each
+// stripe is written with a single call. The file name "-" denotes
+// standard output. Alternatively, a file (but not standard output) can be
+// written in arbitrary order, one span of a row at a time; the two ways
+// of writing must not be mixed.
+class BitmapWriter {
+ public:
+  BitmapWriter();
+  BitmapWriter( const BitmapWriter & ) = delete;
+  BitmapWriter &operator=( const BitmapWriter & ) = delete;
+
+  int open( const std::string &fileName, uint32_t width, uint32_t height );
+  int writeRow( const uint32_t *row );
+  int writeSpan( uint32_t y, uint32_t x, uint32_t count, const uint32_t *src );
+  int flush();
+  int close();
+
+ private:
+  std::ofstream file;
+  std::ostream *output;
+  std::vector<uint8_t> stripe, span;
+  uint32_t w, h;
+  size_t rowSize;
+  uint32_t stripeRows, pending;
+  bool sized;
+};
 
 int saveBitmap(	const uint32_t *data, uint32_t width, uint32_t height,
 		const std::string &fileName );
 int loadBitmap(	const std::string &fileName, uint32_t *&data,
-		uint16_t &width, uint16_t &height );
+		uint32_t &width, uint32_t &height );
 int loadBitmapPadded( const std::string &fileName, uint32_t *&data,
-		      uint16_t &width, uint16_t &height, uint16_t pad );
+		      uint32_t &width, uint32_t &height, uint16_t pad );
 
 #endif
@@ -0,0 +1,40 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#ifndef __JANERT_PIXELSCALERS_CPU__
+#define __JANERT_PIXELSCALERS_CPU__
+
+// Instruction set extensions that have specialized code paths, in order
+// of increasing capability. A level implies all levels below it.
+enum CpuLevel { CPU_SCALAR = 0, CPU_SSSE3, CPU_AVX2, CPU_AVX512 };
+
+// Returns the highest level supported by the processor. The environment
+// variable PIXELSCALER_SIMD (one of: scalar ssse3 avx2 avx512) lowers the
+// level, which is useful to compare specialized code against the fallback.
+CpuLevel cpuLevel();
+
+#endif
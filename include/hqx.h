@@ -28,6 +28,35 @@ void hq2xB( uint32_t *img, int w, int h, uint32_t *out );
 void hq3xA( uint32_t *img, int w, int h, uint32_t *out );
 void hq3xB( uint32_t *img, int w, int h, uint32_t *out );
 
+// Enables a cache of recent 3x3 windows and their output blocks, for
+// images where the same neighbourhoods repeat, such as tiled pixel art.
+// The lookups and hits since the cache was enabled are available from
+// hqxCacheStats.
+void setHqxCache( bool enabled );
+void hqxCacheStats( uint64_t &lookups, uint64_t &hits );
+
+// Scales in two steps: first the blend kernel of every pixel is found,
+// then the pixels are bucketed by kernel, and each bucket is blended
+// eight pixels at a time with AVX2. Without AVX2, or with the cache
+// enabled, pixels are scaled one at a time as usual.
+void setHqxBuckets( bool enabled );
+
+// Counts of what hqx does per pixel: how often each pattern occurs, how
+// often each tie-break test (w[1]/w[5], w[5]/w[7], w[7]/w[3], w[3]/w[1])
+// is run and finds a difference, and how many of the neighbour
+// comparisons that make up the pattern are settled by the colors being
+// equal, without a YUV test. Only collected if built with HQX_STATS;
+// setHqxStats returns false otherwise. Enabling resets the counts.
+struct HqxStats {
+	uint64_t pixels;
+	uint64_t patterns[256];
+	uint64_t tests[4], differences[4];
+	uint64_t comparisons, equal;
+};
+
+bool setHqxStats( bool enabled );
+void hqxStats( HqxStats &stats );
+
 #endif
 
 
@@ -25,13 +25,95 @@
    For the public header file, see hqx.h */
 
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "cpu.h"
+#include "threads.h"
 
 uint32_t ARGBtoAYUV( uint32_t value );
-bool isDifferentA( uint32_t color1, uint32_t color2,
-		   uint32_t trY, uint32_t trU, uint32_t trV, uint32_t trA );
-bool isDifferentB( uint32_t color1, uint32_t color2,
-		   uint32_t trY, uint32_t trU, uint32_t trV, uint32_t trA );
+void imageToAYUV( const uint32_t *image, int w, int h, uint32_t *yuv );
+
+static const uint32_t AMASK = 0xFF000000;
+static const uint32_t YMASK = 0x00FF0000;
+static const uint32_t UMASK = 0x0000FF00;
+static const uint32_t VMASK = 0x000000FF;
+
+/*
+ * Use this function for sharper images (good for cartoon style, used by DOSBOX)
+ *
+ * PKJ: Both colors are expected in AYUV, as returned by ARGBtoAYUV, so
+ * that each pixel needs to be converted only once, not for every
+ * comparison.
+ */
+inline bool isDifferentA(
+	uint32_t color1,
+	uint32_t color2,
+	uint32_t trY,
+	uint32_t trU,
+	uint32_t trV,
+	uint32_t trA )
+{
+	uint32_t value;
+
+	value = abs(int(color1 & YMASK) - int(color2 & YMASK));
+	if (value > trY) return true;
+
+	value = abs(int(color1 & UMASK) - int(color2 & UMASK));
+	if (value > trU) return true;
+
+	value = abs(int(color1 & VMASK) - int(color2 & VMASK));
+	if (value > trV) return true;
+
+	value = abs(int(color1 & AMASK) - int(color2 & AMASK));
+	if (value > trA) return true;
+
+	return false;
+}
+
+/*
+ * Use this function for smoothed images (good for complex graphics)
+ *
+ * PKJ: Both colors are expected in AYUV, as for isDifferentA.
+ */
+inline bool isDifferentB(
+	uint32_t yuv1,
+	uint32_t yuv2,
+	uint32_t trY,
+	uint32_t trU,
+	uint32_t trV,
+	uint32_t trA )
+{
+	return abs(int(yuv1 & YMASK) - int(yuv2 & YMASK)) > trY ||
+		   abs(int(yuv1 & UMASK) - int(yuv2 & UMASK)) > trU ||
+		   abs(int(yuv1 & VMASK) - int(yuv2 & VMASK)) > trV ||
+		   abs(int(yuv1 & AMASK) - int(yuv2 & AMASK)) > trA;
+}
+
+// isDifferentA or isDifferentB, chosen at compile time.
+template <char Mode>
+inline bool isDifferent( uint32_t color1, uint32_t color2,
+			 uint32_t trY, uint32_t trU, uint32_t trV, uint32_t trA )
+{
+	if (Mode == 'B')
+		return isDifferentB( color1, color2, trY, trU, trV, trA );
+	return isDifferentA( color1, color2, trY, trU, trV, trA );
+}
+
+void patternPlane( char mode, const uint32_t *image, const uint32_t *yuv,
+		   int w, int h, uint32_t trY, uint32_t trU, uint32_t trV,
+		   uint32_t trA, bool wrapX, bool wrapY, uint8_t *patterns );
 
 
 
@@ -40,119 +122,850 @@ bool isDifferentB( uint32_t color1, uint32_t color2,
 #define MASK_A    0xFF000000
 
 
+// The base 2 logarithm of a power of two.
+constexpr int hqxLog2( unsigned n )
+{
+	return n > 1 ? 1 + hqxLog2( n / 2 ) : 0;
+}
+
+// The four channels of a color, 16 bits apart: red and blue in the lower
+// half, alpha and green in the upper. A blend of up to 256 parts fits.
+inline uint64_t hqxWiden( uint32_t c )
+{
+	return (uint64_t) (c >> 8 & MASK_RB) << 32 | (c & MASK_RB);
+}
+
+inline uint32_t hqxNarrow( uint64_t c )
+{
+	return (uint32_t) (c & MASK_RB) | (uint32_t) (c >> 24 & ~MASK_RB);
+}
+
+/**
+ * @brief Mixes three colors using the given weights. The weights must sum
+ * to a power of two, so that each channel is divided with a shift; the
+ * result is the same as with a division.
+ */
+template <unsigned W0, unsigned W1, unsigned W2>
+__attribute__((always_inline))
+inline uint32_t hqxMix3( uint32_t c0, uint32_t c1, uint32_t c2 )
+{
+	constexpr unsigned sum = W0 + W1 + W2;
+	static_assert( sum > 0 && (sum & (sum - 1)) == 0 && sum <= 256,
+		       "the weights must sum to a power of two, at most 256" );
+
+	uint64_t c = hqxWiden( c0 ) * W0 + hqxWiden( c1 ) * W1;
+	if (W2 > 0)
+		c += hqxWiden( c2 ) * W2;
+	return hqxNarrow( c >> hqxLog2( sum ) );
+}
+
 /**
- * @brief Mixes two colors using the given weights.
- */
-#define HQX_MIX_2(C0,C1,W0,W1) \
-	((((C0 & MASK_RB) * W0 + (C1 & MASK_RB) * W1) / (W0 + W1)) & MASK_RB) | \
-	((((C0 & MASK_G)  * W0 + (C1 & MASK_G)  * W1) / (W0 + W1)) & MASK_G)  | \
-	((((((C0 & MASK_A) >> 8)  * W0 + ((C1 & MASK_A) >> 8) * W1) / (W0 + W1)) << 8) & MASK_A)
-
-/**
- * @brief Mixes three colors using the given weights.
- */
-#define HQX_MIX_3(C0,C1,C2,W0,W1,W2) \
-	((((C0 & MASK_RB) * W0 + (C1 & MASK_RB) * W1 + (C2 & MASK_RB) * W2) / (W0 + W1 + W2)) & MASK_RB) | \
-	((((C0 & MASK_G)  * W0 + (C1 & MASK_G)  * W1 + (C2 & MASK_G)  * W2) / (W0 + W1 + W2)) & MASK_G)  | \
-	((((((C0 & MASK_A) >> 8) * W0 + ((C1 & MASK_A) >> 8) * W1 + ((C2 & MASK_A) >> 8) * W2) / (W0 + W1 + W2)) << 8) & MASK_A)
-
-
-#define MIX_00_4				*output = w[4];
-#define MIX_00_4_0_3_1			*output = HQX_MIX_2(w[4],w[0],3U,1U);
-#define MIX_00_4_3_3_1			*output = HQX_MIX_2(w[4],w[3],3U,1U);
-#define MIX_00_4_1_3_1			*output = HQX_MIX_2(w[4],w[1],3U,1U);
-#define MIX_00_3_1_1_1			*output = HQX_MIX_2(w[3],w[1],1U,1U);
-#define MIX_00_4_3_1_2_1_1		*output = HQX_MIX_3(w[4],w[3],w[1],2U,1U,1U);
-#define MIX_00_4_3_1_2_7_7 		*output = HQX_MIX_3(w[4],w[3],w[1],2U,7U,7U);
-#define MIX_00_4_0_1_2_1_1		*output = HQX_MIX_3(w[4],w[0],w[1],2U,1U,1U);
-#define MIX_00_4_0_3_2_1_1		*output = HQX_MIX_3(w[4],w[0],w[3],2U,1U,1U);
-#define MIX_00_4_1_3_5_2_1		*output = HQX_MIX_3(w[4],w[1],w[3],5U,2U,1U);
-#define MIX_00_4_3_1_5_2_1		*output = HQX_MIX_3(w[4],w[3],w[1],5U,2U,1U);
-#define MIX_00_4_3_1_6_1_1		*output = HQX_MIX_3(w[4],w[3],w[1],6U,1U,1U);
-#define MIX_00_4_3_1_2_3_3		*output = HQX_MIX_3(w[4],w[3],w[1],2U,3U,3U);
-#define MIX_00_4_3_1_e_1_1		*output = HQX_MIX_3(w[4],w[3],w[1],14U,1U,1U);
-
-#define MIX_01_4			*(output + 1) = w[4];
-#define MIX_01_4_2_3_1		*(output + 1) = HQX_MIX_2(w[4],w[2],3U,1U);
-#define MIX_01_4_1_3_1		*(output + 1) = HQX_MIX_2(w[4],w[1],3U,1U);
-#define MIX_01_1_4_3_1		*(output + 1) = HQX_MIX_2(w[1],w[4],3U,1U);
-#define MIX_01_4_5_3_1		*(output + 1) = HQX_MIX_2(w[4],w[5],3U,1U);
-#define MIX_01_4_1_7_1		*(output + 1) = HQX_MIX_2(w[4],w[1],7U,1U);
-#define MIX_01_4_1_5_2_1_1	*(output + 1) = HQX_MIX_3(w[4],w[1],w[5],2U,1U,1U);
-#define MIX_01_4_2_5_2_1_1	*(output + 1) = HQX_MIX_3(w[4],w[2],w[5],2U,1U,1U);
-#define MIX_01_4_2_1_2_1_1	*(output + 1) = HQX_MIX_3(w[4],w[2],w[1],2U,1U,1U);
-#define MIX_01_4_5_1_5_2_1	*(output + 1) = HQX_MIX_3(w[4],w[5],w[1],5U,2U,1U);
-#define MIX_01_4_1_5_5_2_1	*(output + 1) = HQX_MIX_3(w[4],w[1],w[5],5U,2U,1U);
-#define MIX_01_4_1_5_6_1_1	*(output + 1) = HQX_MIX_3(w[4],w[1],w[5],6U,1U,1U);
-#define MIX_01_4_1_5_2_3_3	*(output + 1) = HQX_MIX_3(w[4],w[1],w[5],2U,3U,3U);
-#define MIX_01_4_1_5_e_1_1	*(output + 1) = HQX_MIX_3(w[4],w[1],w[5],14U,1U,1U);
-
-#define MIX_02_4			*(output + 2) = w[4];
-#define MIX_02_4_2_3_1		*(output + 2) = HQX_MIX_2(w[4],w[2],3U,1U);
-#define MIX_02_4_1_3_1		*(output + 2) = HQX_MIX_2(w[4],w[1],3U,1U);
-#define MIX_02_4_5_3_1  	*(output + 2) = HQX_MIX_2(w[4],w[5],3U,1U);
-#define MIX_02_4_1_5_2_1_1	*(output + 2) = HQX_MIX_3(w[4],w[1],w[5],2U,1U,1U);
-#define MIX_02_4_1_5_2_7_7	*(output + 2) = HQX_MIX_3(w[4],w[1],w[5],2U,7U,7U);
-#define MIX_02_1_5_1_1		*(output + 2) = HQX_MIX_2(w[1],w[5],1U,1U);
-
-#define MIX_10_4			*(output + lineSize) = w[4];
-#define MIX_10_4_6_3_1		*(output + lineSize) = HQX_MIX_2(w[4],w[6],3U,1U);
-#define MIX_10_4_7_3_1		*(output + lineSize) = HQX_MIX_2(w[4],w[7],3U,1U);
-#define MIX_10_4_3_3_1		*(output + lineSize) = HQX_MIX_2(w[4],w[3],3U,1U);
-#define MIX_10_4_7_3_2_1_1	*(output + lineSize) = HQX_MIX_3(w[4],w[7],w[3],2U,1U,1U);
-#define MIX_10_4_6_3_2_1_1	*(output + lineSize) = HQX_MIX_3(w[4],w[6],w[3],2U,1U,1U);
-#define MIX_10_4_6_7_2_1_1	*(output + lineSize) = HQX_MIX_3(w[4],w[6],w[7],2U,1U,1U);
-#define MIX_10_4_3_7_5_2_1	*(output + lineSize) = HQX_MIX_3(w[4],w[3],w[7],5U,2U,1U);
-#define MIX_10_4_7_3_5_2_1	*(output + lineSize) = HQX_MIX_3(w[4],w[7],w[3],5U,2U,1U);
-#define MIX_10_4_7_3_6_1_1	*(output + lineSize) = HQX_MIX_3(w[4],w[7],w[3],6U,1U,1U);
-#define MIX_10_4_7_3_2_3_3	*(output + lineSize) = HQX_MIX_3(w[4],w[7],w[3],2U,3U,3U);
-#define MIX_10_4_7_3_e_1_1	*(output + lineSize) = HQX_MIX_3(w[4],w[7],w[3],14U,1U,1U);
-#define MIX_10_4_3_7_1  	*(output + lineSize) = HQX_MIX_2(w[4],w[3],7U,1U);
-#define MIX_10_3_4_3_1  	*(output + lineSize) = HQX_MIX_2(w[3],w[4],3U,1U);
-
-#define MIX_11_4			*(output + lineSize + 1) = w[4];
-#define MIX_11_4_8_3_1		*(output + lineSize + 1) = HQX_MIX_2(w[4],w[8],3U,1U);
-#define MIX_11_4_5_3_1		*(output + lineSize + 1) = HQX_MIX_2(w[4],w[5],3U,1U);
-#define MIX_11_4_7_3_1		*(output + lineSize + 1) = HQX_MIX_2(w[4],w[7],3U,1U);
-#define MIX_11_4_5_7_2_1_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[5],w[7],2U,1U,1U);
-#define MIX_11_4_8_7_2_1_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[8],w[7],2U,1U,1U);
-#define MIX_11_4_8_5_2_1_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[8],w[5],2U,1U,1U);
-#define MIX_11_4_7_5_5_2_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[7],w[5],5U,2U,1U);
-#define MIX_11_4_5_7_5_2_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[5],w[7],5U,2U,1U);
-#define MIX_11_4_5_7_6_1_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[5],w[7],6U,1U,1U);
-#define MIX_11_4_5_7_2_3_3	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[5],w[7],2U,3U,3U);
-#define MIX_11_4_5_7_e_1_1	*(output + lineSize + 1) = HQX_MIX_3(w[4],w[5],w[7],14U,1U,1U);
-
-#define MIX_12_4			*(output + lineSize + 2) = w[4];
-#define MIX_12_4_5_3_1		*(output + lineSize + 2) = HQX_MIX_2(w[4],w[5],3U,1U);
-#define MIX_12_4_5_7_1		*(output + lineSize + 2) = HQX_MIX_2(w[4],w[5],7U,1U);
-#define MIX_12_5_4_3_1		*(output + lineSize + 2) = HQX_MIX_2(w[5],w[4],3U,1U);
-
-#define MIX_20_4			*(output + lineSize + lineSize) = w[4];
-#define MIX_20_4_6_3_1		*(output + lineSize + lineSize) = HQX_MIX_2(w[4],w[6],3U,1U);
-#define MIX_20_4_7_3_1		*(output + lineSize + lineSize) = HQX_MIX_2(w[4],w[7],3U,1U);
-#define MIX_20_4_3_3_1		*(output + lineSize + lineSize) = HQX_MIX_2(w[4],w[3],3U,1U);
-#define MIX_20_4_7_3_2_1_1	*(output + lineSize + lineSize) = HQX_MIX_3(w[4],w[7],w[3],2U,1U,1U);
-#define MIX_20_4_7_3_2_7_7	*(output + lineSize + lineSize) = HQX_MIX_3(w[4],w[7],w[3],2U,7U,7U);
-#define MIX_20_7_3_1_1		*(output + lineSize + lineSize) = HQX_MIX_2(w[7],w[3],1U,1U);
-
-#define MIX_21_4			*(output + lineSize + lineSize + 1) = w[4];
-#define MIX_21_4_7_3_1		*(output + lineSize + lineSize + 1) = HQX_MIX_2(w[4],w[7],3U,1U);
-#define MIX_21_4_7_7_1		*(output + lineSize + lineSize + 1) = HQX_MIX_2(w[4],w[7],7U,1U);
-#define MIX_21_7_4_3_1		*(output + lineSize + lineSize + 1) = HQX_MIX_2(w[7],w[4],3U,1U);
-
-#define MIX_22_4			*(output + lineSize + lineSize + 2) = w[4];
-#define MIX_22_4_8_3_1		*(output + lineSize + lineSize + 2) = HQX_MIX_2(w[4],w[8],3U,1U);
-#define MIX_22_4_7_3_1		*(output + lineSize + lineSize + 2) = HQX_MIX_2(w[4],w[7],3U,1U);
-#define MIX_22_4_5_3_1		*(output + lineSize + lineSize + 2) = HQX_MIX_2(w[4],w[5],3U,1U);
-#define MIX_22_4_5_7_2_1_1	*(output + lineSize + lineSize + 2) = HQX_MIX_3(w[4],w[5],w[7],2U,1U,1U);
-#define MIX_22_4_5_7_2_7_7	*(output + lineSize + lineSize + 2) = HQX_MIX_3(w[4],w[5],w[7],2U,7U,7U);
-#define MIX_22_5_7_1_1		*(output + lineSize + lineSize + 2) = HQX_MIX_2(w[5],w[7],1U,1U);
+ * @brief Mixes two colors using the given weights, as hqxMix3.
+ */
+template <unsigned W0, unsigned W1>
+__attribute__((always_inline))
+inline uint32_t hqxMix2( uint32_t c0, uint32_t c1 )
+{
+	return hqxMix3<W0, W1, 0>( c0, c1, 0 );
+}
+
+#if defined(__x86_64__) || defined(__i386__)
 
+/**
+ * @brief Mixes eight pairs or triples of colors at once, one per 32 bit
+ * lane, as hqxMix3. The channels are widened to 16 bits. Only for
+ * processors with AVX2.
+ */
+template <unsigned W0, unsigned W1, unsigned W2>
+__attribute__((target("avx2")))
+inline __m256i hqxMix3x8( __m256i c0, __m256i c1, __m256i c2 )
+{
+	constexpr unsigned sum = W0 + W1 + W2;
+	static_assert( sum > 0 && (sum & (sum - 1)) == 0 && sum <= 256,
+		       "the weights must sum to a power of two, at most 256" );
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i w0 = _mm256_set1_epi16( W0 ), w1 = _mm256_set1_epi16( W1 );
+	__m256i lo = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( c0, zero ), w0 ),
+				       _mm256_mullo_epi16( _mm256_unpacklo_epi8( c1, zero ), w1 ) );
+	__m256i hi = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( c0, zero ), w0 ),
+				       _mm256_mullo_epi16( _mm256_unpackhi_epi8( c1, zero ), w1 ) );
+	if (W2 > 0)
+	{
+		const __m256i w2 = _mm256_set1_epi16( W2 );
+		lo = _mm256_add_epi16( lo, _mm256_mullo_epi16( _mm256_unpacklo_epi8( c2, zero ), w2 ) );
+		hi = _mm256_add_epi16( hi, _mm256_mullo_epi16( _mm256_unpackhi_epi8( c2, zero ), w2 ) );
+	}
+	return _mm256_packus_epi16( _mm256_srli_epi16( lo, hqxLog2( sum ) ),
+				    _mm256_srli_epi16( hi, hqxLog2( sum ) ) );
+}
+
+template <unsigned W0, unsigned W1>
+__attribute__((target("avx2")))
+inline __m256i hqxMix2x8( __m256i c0, __m256i c1 )
+{
+	return hqxMix3x8<W0, W1, 0>( c0, c1, c0 );
+}
 
 #endif
 
 
+/**
+ * @brief A blend of up to three colors of the 3x3 window: their indices,
+ * and their weights, for hqxMix2 if the third weight is 0, or hqxMix3.
+ */
+struct HqxBlend {
+	uint8_t src[3];
+	uint8_t wgt[3];
+};
+
+// All blends used by hq2x and hq3x, named after the macros they replace:
+// M_4_1_5_2_1_1 mixes w[4], w[1], w[5] in proportions 2:1:1 (e is 14).
+enum HqxBlendId {
+	M_4,
+	M_1_4_3_1,
+	M_1_5_1_1,
+	M_3_1_1_1,
+	M_3_4_3_1,
+	M_4_0_3_1,
+	M_4_1_3_1,
+	M_4_1_7_1,
+	M_4_2_3_1,
+	M_4_3_3_1,
+	M_4_3_7_1,
+	M_4_5_3_1,
+	M_4_5_7_1,
+	M_4_6_3_1,
+	M_4_7_3_1,
+	M_4_7_7_1,
+	M_4_8_3_1,
+	M_5_4_3_1,
+	M_5_7_1_1,
+	M_7_3_1_1,
+	M_7_4_3_1,
+	M_4_0_1_2_1_1,
+	M_4_0_3_2_1_1,
+	M_4_1_3_5_2_1,
+	M_4_1_5_2_1_1,
+	M_4_1_5_2_3_3,
+	M_4_1_5_2_7_7,
+	M_4_1_5_5_2_1,
+	M_4_1_5_6_1_1,
+	M_4_1_5_e_1_1,
+	M_4_2_1_2_1_1,
+	M_4_2_5_2_1_1,
+	M_4_3_1_2_1_1,
+	M_4_3_1_2_3_3,
+	M_4_3_1_2_7_7,
+	M_4_3_1_5_2_1,
+	M_4_3_1_6_1_1,
+	M_4_3_1_e_1_1,
+	M_4_3_7_5_2_1,
+	M_4_5_1_5_2_1,
+	M_4_5_7_2_1_1,
+	M_4_5_7_2_3_3,
+	M_4_5_7_2_7_7,
+	M_4_5_7_5_2_1,
+	M_4_5_7_6_1_1,
+	M_4_5_7_e_1_1,
+	M_4_6_3_2_1_1,
+	M_4_6_7_2_1_1,
+	M_4_7_3_2_1_1,
+	M_4_7_3_2_3_3,
+	M_4_7_3_2_7_7,
+	M_4_7_3_5_2_1,
+	M_4_7_3_6_1_1,
+	M_4_7_3_e_1_1,
+	M_4_7_5_5_2_1,
+	M_4_8_5_2_1_1,
+	M_4_8_7_2_1_1,
+	HQX_BLENDS
+};
 
+// The sources and weights of the blends in HqxBlendId, in the same order.
+constexpr HqxBlend hqxBlends[HQX_BLENDS] = {
+	{ { 4, 4, 4 }, {  1,  0,  0 } },	// M_4
+	{ { 1, 4, 1 }, {  3,  1,  0 } },	// M_1_4_3_1
+	{ { 1, 5, 1 }, {  1,  1,  0 } },	// M_1_5_1_1
+	{ { 3, 1, 3 }, {  1,  1,  0 } },	// M_3_1_1_1
+	{ { 3, 4, 3 }, {  3,  1,  0 } },	// M_3_4_3_1
+	{ { 4, 0, 4 }, {  3,  1,  0 } },	// M_4_0_3_1
+	{ { 4, 1, 4 }, {  3,  1,  0 } },	// M_4_1_3_1
+	{ { 4, 1, 4 }, {  7,  1,  0 } },	// M_4_1_7_1
+	{ { 4, 2, 4 }, {  3,  1,  0 } },	// M_4_2_3_1
+	{ { 4, 3, 4 }, {  3,  1,  0 } },	// M_4_3_3_1
+	{ { 4, 3, 4 }, {  7,  1,  0 } },	// M_4_3_7_1
+	{ { 4, 5, 4 }, {  3,  1,  0 } },	// M_4_5_3_1
+	{ { 4, 5, 4 }, {  7,  1,  0 } },	// M_4_5_7_1
+	{ { 4, 6, 4 }, {  3,  1,  0 } },	// M_4_6_3_1
+	{ { 4, 7, 4 }, {  3,  1,  0 } },	// M_4_7_3_1
+	{ { 4, 7, 4 }, {  7,  1,  0 } },	// M_4_7_7_1
+	{ { 4, 8, 4 }, {  3,  1,  0 } },	// M_4_8_3_1
+	{ { 5, 4, 5 }, {  3,  1,  0 } },	// M_5_4_3_1
+	{ { 5, 7, 5 }, {  1,  1,  0 } },	// M_5_7_1_1
+	{ { 7, 3, 7 }, {  1,  1,  0 } },	// M_7_3_1_1
+	{ { 7, 4, 7 }, {  3,  1,  0 } },	// M_7_4_3_1
+	{ { 4, 0, 1 }, {  2,  1,  1 } },	// M_4_0_1_2_1_1
+	{ { 4, 0, 3 }, {  2,  1,  1 } },	// M_4_0_3_2_1_1
+	{ { 4, 1, 3 }, {  5,  2,  1 } },	// M_4_1_3_5_2_1
+	{ { 4, 1, 5 }, {  2,  1,  1 } },	// M_4_1_5_2_1_1
+	{ { 4, 1, 5 }, {  2,  3,  3 } },	// M_4_1_5_2_3_3
+	{ { 4, 1, 5 }, {  2,  7,  7 } },	// M_4_1_5_2_7_7
+	{ { 4, 1, 5 }, {  5,  2,  1 } },	// M_4_1_5_5_2_1
+	{ { 4, 1, 5 }, {  6,  1,  1 } },	// M_4_1_5_6_1_1
+	{ { 4, 1, 5 }, { 14,  1,  1 } },	// M_4_1_5_e_1_1
+	{ { 4, 2, 1 }, {  2,  1,  1 } },	// M_4_2_1_2_1_1
+	{ { 4, 2, 5 }, {  2,  1,  1 } },	// M_4_2_5_2_1_1
+	{ { 4, 3, 1 }, {  2,  1,  1 } },	// M_4_3_1_2_1_1
+	{ { 4, 3, 1 }, {  2,  3,  3 } },	// M_4_3_1_2_3_3
+	{ { 4, 3, 1 }, {  2,  7,  7 } },	// M_4_3_1_2_7_7
+	{ { 4, 3, 1 }, {  5,  2,  1 } },	// M_4_3_1_5_2_1
+	{ { 4, 3, 1 }, {  6,  1,  1 } },	// M_4_3_1_6_1_1
+	{ { 4, 3, 1 }, { 14,  1,  1 } },	// M_4_3_1_e_1_1
+	{ { 4, 3, 7 }, {  5,  2,  1 } },	// M_4_3_7_5_2_1
+	{ { 4, 5, 1 }, {  5,  2,  1 } },	// M_4_5_1_5_2_1
+	{ { 4, 5, 7 }, {  2,  1,  1 } },	// M_4_5_7_2_1_1
+	{ { 4, 5, 7 }, {  2,  3,  3 } },	// M_4_5_7_2_3_3
+	{ { 4, 5, 7 }, {  2,  7,  7 } },	// M_4_5_7_2_7_7
+	{ { 4, 5, 7 }, {  5,  2,  1 } },	// M_4_5_7_5_2_1
+	{ { 4, 5, 7 }, {  6,  1,  1 } },	// M_4_5_7_6_1_1
+	{ { 4, 5, 7 }, { 14,  1,  1 } },	// M_4_5_7_e_1_1
+	{ { 4, 6, 3 }, {  2,  1,  1 } },	// M_4_6_3_2_1_1
+	{ { 4, 6, 7 }, {  2,  1,  1 } },	// M_4_6_7_2_1_1
+	{ { 4, 7, 3 }, {  2,  1,  1 } },	// M_4_7_3_2_1_1
+	{ { 4, 7, 3 }, {  2,  3,  3 } },	// M_4_7_3_2_3_3
+	{ { 4, 7, 3 }, {  2,  7,  7 } },	// M_4_7_3_2_7_7
+	{ { 4, 7, 3 }, {  5,  2,  1 } },	// M_4_7_3_5_2_1
+	{ { 4, 7, 3 }, {  6,  1,  1 } },	// M_4_7_3_6_1_1
+	{ { 4, 7, 3 }, { 14,  1,  1 } },	// M_4_7_3_e_1_1
+	{ { 4, 7, 5 }, {  5,  2,  1 } },	// M_4_7_5_5_2_1
+	{ { 4, 8, 5 }, {  2,  1,  1 } },	// M_4_8_5_2_1_1
+	{ { 4, 8, 7 }, {  2,  1,  1 } },	// M_4_8_7_2_1_1
+};
+
+// The tie-break tests: T_15 compares w[1] and w[5], and so on. T_NONE is
+// never set, for sub-pixels that do not depend on a test.
+enum HqxTest { T_15, T_57, T_73, T_31, T_NONE };
+
+/**
+ * @brief The rule for one output sub-pixel: the blend to use if the test
+ * finds a difference, and the blend to use if not.
+ */
+struct HqxRule {
+	uint8_t test;
+	uint8_t different;
+	uint8_t same;
+};
 
+/**
+ * @brief The rules of one pattern: the tests they depend on, and the rule
+ * for each of the N output sub-pixels.
+ */
+template <int N>
+struct HqxRules {
+	uint8_t tests;
+	HqxRule sub[N];
+};
+
+/**
+ * @brief Computes one blend of the window w.
+ */
+template <int Id>
+__attribute__((always_inline))
+inline uint32_t hqxMix( const uint32_t *w )
+{
+	constexpr HqxBlend b = hqxBlends[Id];
+	if constexpr (b.wgt[2] == 0)
+		return hqxMix2<b.wgt[0], b.wgt[1]>( w[b.src[0]], w[b.src[1]] );
+	else
+		return hqxMix3<b.wgt[0], b.wgt[1], b.wgt[2]>( w[b.src[0]], w[b.src[1]],
+							       w[b.src[2]] );
+}
+
+typedef void (*HqxKernel)( const uint32_t *w, uint32_t *output,
+			   ptrdiff_t lineSize );
+
+/**
+ * @brief Computes the S x S output sub-pixels, left to right and top to
+ * bottom, as the blends Ids of the window w, specialized at compile time.
+ */
+template <int S, int... Ids>
+void hqxKernel( const uint32_t *w, uint32_t *output, ptrdiff_t lineSize )
+{
+	const uint32_t c[9] = { w[0], w[1], w[2], w[3], w[4],
+				w[5], w[6], w[7], w[8] };
+	int k = 0;
+	((output[k / S * lineSize + k % S] = hqxMix<Ids>( c ), k++), ...);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @brief Computes one blend for eight windows at once, one per 32 bit
+ * lane of each of the nine window colors c.
+ */
+template <int Id>
+__attribute__((target("avx2"), always_inline))
+inline __m256i hqxMixx8( const __m256i *c )
+{
+	constexpr HqxBlend b = hqxBlends[Id];
+	if constexpr (b.wgt[2] == 0)
+		return hqxMix2x8<b.wgt[0], b.wgt[1]>( c[b.src[0]], c[b.src[1]] );
+	else
+		return hqxMix3x8<b.wgt[0], b.wgt[1], b.wgt[2]>( c[b.src[0]], c[b.src[1]],
+								 c[b.src[2]] );
+}
+
+// Gathers window color K of eight pixels, if the blends use it.
+template <unsigned Used, int K>
+__attribute__((target("avx2"), always_inline))
+inline void hqxGather8( const uint32_t *image, ptrdiff_t offset, __m256i index,
+			__m256i *c )
+{
+	if constexpr ((Used >> K & 1) != 0)
+		c[K] = _mm256_i32gather_epi32( (const int *) (image + offset), index, 4 );
+}
+
+typedef void (*HqxBucketKernel)( const uint32_t *image, ptrdiff_t width,
+				 const int32_t *pixels, const int32_t *outputs,
+				 size_t n, uint32_t *output, ptrdiff_t lineSize );
+
+/**
+ * @brief Computes the S x S output sub-pixels of the n interior pixels
+ * at the given offsets into the image, writing them at the given offsets
+ * into the output, as hqxKernel does for one window. All pixels share the
+ * blends Ids, so eight at a time are gathered from the image, blended
+ * with AVX2 and scattered to the output; the remainder goes through
+ * hqxKernel.
+ */
+template <int S, int... Ids>
+__attribute__((target("avx2")))
+void hqxBucketKernel( const uint32_t *image, ptrdiff_t width,
+		      const int32_t *pixels, const int32_t *outputs,
+		      size_t n, uint32_t *output, ptrdiff_t lineSize )
+{
+	constexpr unsigned used = ((1u << hqxBlends[Ids].src[0] |
+				    1u << hqxBlends[Ids].src[1] |
+				    (hqxBlends[Ids].wgt[2] ? 1u << hqxBlends[Ids].src[2] : 0)) | ...);
+
+	size_t j = 0;
+	for (; j + 8 <= n; j += 8)
+	{
+		const __m256i index = _mm256_loadu_si256( (const __m256i *) (pixels + j) );
+		__m256i c[9];
+		hqxGather8<used, 0>( image, -width - 1, index, c );
+		hqxGather8<used, 1>( image, -width, index, c );
+		hqxGather8<used, 2>( image, -width + 1, index, c );
+		hqxGather8<used, 3>( image, -1, index, c );
+		hqxGather8<used, 4>( image, 0, index, c );
+		hqxGather8<used, 5>( image, 1, index, c );
+		hqxGather8<used, 6>( image, width - 1, index, c );
+		hqxGather8<used, 7>( image, width, index, c );
+		hqxGather8<used, 8>( image, width + 1, index, c );
+
+		alignas(32) uint32_t blocks[S * S][8];
+		int k = 0;
+		((_mm256_store_si256( (__m256i *) blocks[k], hqxMixx8<Ids>( c ) ), k++), ...);
+
+		for (int lane = 0; lane < 8; lane++)
+		{
+			uint32_t *o = output + outputs[j + lane];
+			for (k = 0; k < S * S; k++)
+				o[k / S * lineSize + k % S] = blocks[k][lane];
+		}
+	}
+
+	for (; j < n; j++)
+	{
+		const uint32_t *p = image + pixels[j];
+		const uint32_t w[9] = { p[-width - 1], p[-width], p[-width + 1],
+					p[-1], p[0], p[1],
+					p[width - 1], p[width], p[width + 1] };
+		hqxKernel<S, Ids...>( w, output + outputs[j], lineSize );
+	}
+}
+
+#endif
+
+/**
+ * @brief The blend kernels for a table of rules, one for each pattern and
+ * outcome of its tests, at index pattern * 16 + tests. Patterns and
+ * outcomes that come down to the same blends share a kernel.
+ */
+template <int S, const HqxRules<S * S> (&Table)[256]>
+struct HqxKernels {
+	static constexpr int blendOf( int pattern, int tests, int k ) {
+		return (tests >> Table[pattern].sub[k].test) & 1 ?
+			Table[pattern].sub[k].different : Table[pattern].sub[k].same;
+	}
+
+	template <size_t I, size_t... K>
+	static constexpr HqxKernel kernel( std::index_sequence<K...> ) {
+		return &hqxKernel<S, blendOf( I / 16, I % 16, K )...>;
+	}
+
+	template <size_t... I>
+	static constexpr std::array<HqxKernel, sizeof...(I)>
+	make( std::index_sequence<I...> ) {
+		return { { kernel<I>( std::make_index_sequence<S * S>() )... } };
+	}
+
+	static constexpr std::array<HqxKernel, 256 * 16> table =
+		make( std::make_index_sequence<256 * 16>() );
+
+#if defined(__x86_64__) || defined(__i386__)
+	template <size_t I, size_t... K>
+	static constexpr HqxBucketKernel bucketKernel( std::index_sequence<K...> ) {
+		return &hqxBucketKernel<S, blendOf( I / 16, I % 16, K )...>;
+	}
+
+	template <size_t... I>
+	static constexpr std::array<HqxBucketKernel, sizeof...(I)>
+	makeBuckets( std::index_sequence<I...> ) {
+		return { { bucketKernel<I>( std::make_index_sequence<S * S>() )... } };
+	}
+
+	// The same kernels, for buckets of pixels (see hqxResizeBuckets)
+	static constexpr std::array<HqxBucketKernel, 256 * 16> buckets =
+		makeBuckets( std::make_index_sequence<256 * 16>() );
+#endif
+};
+
+// The optional cache of recent windows (see setHqxCache), and the totals
+// of its lookups and hits, to which each band adds its own.
+bool hqxCacheEnabled();
+void hqxCacheCount( uint64_t lookups, uint64_t hits );
+
+/**
+ * @brief A cache of recent 3x3 windows, and the S x S blocks they were
+ * scaled to, direct mapped on a hash of the window. The block only
+ * depends on the window (and the mode and thresholds, which are fixed for
+ * a cache), so a hit skips the tests and the blends.
+ */
+template <int S>
+struct HqxCache {
+	enum { BITS = 10 };
 
+	struct Entry {
+		uint32_t window[9];
+		uint32_t block[S * S];
+		bool used;
+	};
+
+	std::vector<Entry> entries;
+	uint64_t lookups, hits;
+
+	HqxCache() : entries( 1 << BITS ), lookups( 0 ), hits( 0 ) {}
+
+	Entry &slot( const uint32_t *w ) {
+		uint32_t hash = w[0] * 0x9E3779B1u + w[1] * 0x85EBCA77u +
+			w[2] * 0xC2B2AE3Du + w[3] * 0x27D4EB2Fu + w[4] * 0x165667B1u +
+			w[5] * 0xD3A2646Cu + w[6] * 0xFD7046C5u + w[7] * 0xB55A4F09u +
+			w[8] * 0x7FEB352Du;
+		return entries[hash >> (32 - BITS)];
+	}
+};
+
+/**
+ * @brief The pixels of an ARGB image to be scaled, as hqxResize sees them:
+ * the image, with its AYUV plane and pattern plane. Pixels are addressed
+ * by their index in the image.
+ */
+template <char Mode>
+struct HqxPlanes {
+	const uint32_t *image;
+	const uint32_t *yuv;
+	const uint8_t *patterns;
+	uint32_t trY, trU, trV, trA;
+
+	HqxPlanes( const uint32_t *image, const uint32_t *yuv,
+		   const uint8_t *patterns, uint32_t trY, uint32_t trU,
+		   uint32_t trV, uint32_t trA )
+		: image( image ), yuv( yuv ), patterns( patterns ),
+		  trY( trY << 16 ), trU( trU << 8 ), trV( trV ), trA( trA << 24 ) {}
+
+	uint32_t color( size_t i ) const { return image[i]; }
+
+	bool different( size_t i, size_t j ) const {
+		return isDifferent<Mode>( yuv[i], yuv[j], trY, trU, trV, trA );
+	}
+
+	int pattern( size_t i, const ptrdiff_t * ) const { return patterns[i]; }
+};
+
+/**
+ * @brief The pixels of an image with at most 256 colors: an index into
+ * the palette for each pixel, and for each pair of palette colors, one
+ * bit for whether they are different. The pattern plane is computed from
+ * the indices, and the tie-break tests are looked up, so the AYUV plane
+ * is not needed. The colors are looked up in the palette too, so that
+ * scaling reads one byte per pixel rather than four; only the bucket
+ * kernels (see hqxResizeBuckets) gather from the image itself.
+ */
+struct HqxPalette {
+	const uint32_t *image;
+	const uint32_t *palette;
+	const uint8_t *indices;
+	const uint32_t *differences;	// 256 rows of 256 bits
+	const uint8_t *patterns;
+
+	uint32_t color( size_t i ) const { return palette[indices[i]]; }
+
+	bool different( size_t i, size_t j ) const {
+		uint8_t a = indices[i], b = indices[j];
+		return differences[a * 8 + (b >> 5)] >> (b & 31) & 1;
+	}
+
+	int pattern( size_t i, const ptrdiff_t * ) const { return patterns[i]; }
+};
+
+// Finds the colors of a w x h image. If there are at most 256, returns
+// their number, with the colors in palette and an index into it for each
+// pixel in indices; otherwise returns 0.
+int findPalette( const uint32_t *image, int w, int h,
+		 uint32_t *palette, uint8_t *indices );
+
+// Fills the difference bits of HqxPalette for n palette colors, as
+// isDifferentA ('A') or isDifferentB ('B') finds them, with the same
+// thresholds as patternPlane.
+void paletteDifferences( char mode, const uint32_t *palette, int n,
+			 uint32_t trY, uint32_t trU, uint32_t trV, uint32_t trA,
+			 uint32_t *differences );
+
+// Computes the pattern plane of a palette image from its indices and
+// difference bits, without wrapping.
+void palettePatterns( const uint8_t *indices, const uint32_t *differences,
+		      int w, int h, uint8_t *patterns );
+
+#ifdef HQX_STATS
+// Adds a pixel to the counts of setHqxStats: its pattern, the tie-break
+// tests its rules needed and those that found a difference, and its
+// window.
+bool hqxStatsEnabled();
+void hqxStatsCount( int pattern, int needed, int tests, const uint32_t *w );
+#endif
+
+/**
+ * @brief Runs the tie-break tests in needed (the tests of a pattern's
+ * rules) on the neighbours of pixel i, and returns those that find a
+ * difference.
+ */
+template <class Source>
+__attribute__((always_inline))
+inline int hqxTests( int needed, const Source &src, size_t i,
+		     ptrdiff_t previous, ptrdiff_t next,
+		     ptrdiff_t left, ptrdiff_t right )
+{
+	int tests = 0;
+	if ((needed & 1 << T_15) && src.different( i + previous, i + right ))
+		tests |= 1 << T_15;
+	if ((needed & 1 << T_57) && src.different( i + right, i + next ))
+		tests |= 1 << T_57;
+	if ((needed & 1 << T_73) && src.different( i + next, i + left ))
+		tests |= 1 << T_73;
+	if ((needed & 1 << T_31) && src.different( i + left, i + previous ))
+		tests |= 1 << T_31;
+	return tests;
+}
+
+/**
+ * @brief Scales the pixel at index i of the image by S. Its neighbours
+ * are at the offsets previous and next (the rows above and below) and
+ * left and right; at the border of the image, these point to the pixels
+ * that stand in for the missing neighbours. The cache, if any, is looked
+ * up first, and filled on a miss.
+ */
+template <int S, class Source>
+__attribute__((always_inline))
+inline void hqxPixel( const HqxRules<S * S> *rules, const HqxKernel *kernels,
+		      const Source &src, size_t i,
+		      ptrdiff_t previous, ptrdiff_t next,
+		      ptrdiff_t left, ptrdiff_t right,
+		      uint32_t *output, ptrdiff_t lineSize, HqxCache<S> *cache )
+{
+	const uint32_t w[9] = {
+		src.color( i + previous + left ), src.color( i + previous ),
+		src.color( i + previous + right ), src.color( i + left ),
+		src.color( i ), src.color( i + right ),
+		src.color( i + next + left ), src.color( i + next ),
+		src.color( i + next + right ) };
+
+	typename HqxCache<S>::Entry *entry = nullptr;
+	if (cache)
+	{
+		entry = &cache->slot( w );
+		cache->lookups++;
+		if (entry->used && memcmp( entry->window, w, sizeof w ) == 0)
+		{
+			cache->hits++;
+			for (int k = 0; k < S * S; k++)
+				output[k / S * lineSize + k % S] = entry->block[k];
+			return;
+		}
+	}
+
+	const ptrdiff_t around[8] = {
+		previous + left, previous, previous + right, left, right,
+		next + left, next, next + right };
+	const int pattern = src.pattern( i, around );
+
+	const int tests = hqxTests( rules[pattern].tests, src, i,
+				    previous, next, left, right );
+#ifdef HQX_STATS
+	if (hqxStatsEnabled())
+		hqxStatsCount( pattern, rules[pattern].tests, tests, w );
+#endif
+
+	kernels[pattern * 16 + tests]( w, output, lineSize );
+
+	if (entry)
+	{
+		memcpy( entry->window, w, sizeof w );
+		for (int k = 0; k < S * S; k++)
+			entry->block[k] = output[k / S * lineSize + k % S];
+		entry->used = true;
+	}
+}
+
+/**
+ * @brief Scales the rows rowBegin to rowEnd of a width x height image by
+ * S, following the rules and their kernels. Output points to the first
+ * output row of the band. Neighbours beyond the edge of the image repeat
+ * the edge. The pixels at the left and right edge are handled apart, so
+ * that the loop over the interior has no branches. The cache may be null.
+ */
+template <int S, class Source>
+uint32_t *hqxResize( const HqxRules<S * S> *rules, const HqxKernel *kernels,
+		     const Source &src, uint32_t width, uint32_t height,
+		     uint32_t *output, uint32_t rowBegin, uint32_t rowEnd,
+		     HqxCache<S> *cache )
+{
+	const ptrdiff_t lineSize = (ptrdiff_t) width * S;
+	const ptrdiff_t last = (ptrdiff_t) width - 1;
+
+	// every line only depends on its own position, so bands can be
+	// computed independently
+	for (uint32_t row = rowBegin; row < rowEnd; row++)
+	{
+		const size_t start = (size_t) row * width;
+
+		const ptrdiff_t previous = row > 0 ? -(ptrdiff_t) width : 0;
+		const ptrdiff_t next = row < height - 1 ? (ptrdiff_t) width : 0;
+
+		// the left edge; with a single column, also the right edge
+		hqxPixel<S>( rules, kernels, src, start, previous, next,
+			     0, width > 1 ? 1 : 0,
+			     output, lineSize, cache );
+
+		for (ptrdiff_t col = 1; col < last; col++)
+			hqxPixel<S>( rules, kernels, src, start + col, previous, next,
+				     -1, 1, output + col * S, lineSize, cache );
+
+		if (width > 1)
+			hqxPixel<S>( rules, kernels, src, start + last, previous, next,
+				     -1, 0, output + last * S, lineSize, cache );
+
+		output += lineSize * S;
+	}
+
+	return output;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The rows of a band that are bucketed together; small enough to keep
+// their pixels and output in cache.
+static const uint32_t hqxBucketRows = 4;
+
+/**
+ * @brief Scales the rows rowBegin to rowEnd of a width x height image by
+ * S, as hqxResize, but in two steps: first the kernel of
+ * each interior pixel is found from its pattern and tests, and the pixels
+ * are bucketed by kernel; then each bucket is run through its kernel, for
+ * eight pixels at a time. Pixels on the border of the image go through
+ * hqxPixel. Needs AVX2.
+ */
+template <int S, class Source>
+void hqxResizeBuckets( const HqxRules<S * S> *rules, const HqxKernel *kernels,
+		       const HqxBucketKernel *buckets, const Source &src,
+		       uint32_t width, uint32_t height, uint32_t *output,
+		       uint32_t rowBegin, uint32_t rowEnd )
+{
+	const ptrdiff_t lineSize = (ptrdiff_t) width * S;
+	const ptrdiff_t last = (ptrdiff_t) width - 1;
+
+	if (width < 3)
+	{
+		hqxResize<S>( rules, kernels, src, width, height,
+			      output, rowBegin, rowEnd, nullptr );
+		return;
+	}
+
+	const size_t band = (size_t) hqxBucketRows * width;
+	std::vector<uint16_t> keys( band );
+	std::vector<int32_t> pixels( band ), outputs( band );
+	std::vector<uint32_t> counts( 256 * 16 + 1 );
+
+	for (uint32_t j0 = rowBegin; j0 < rowEnd; j0 += hqxBucketRows)
+	{
+		const uint32_t j1 = std::min( j0 + hqxBucketRows, rowEnd );
+		const size_t start = (size_t) j0 * width;
+		uint32_t *out = output + (size_t) (j0 - rowBegin) * lineSize * S;
+		const ptrdiff_t around[8] = {
+			-(ptrdiff_t) width - 1, -(ptrdiff_t) width, -(ptrdiff_t) width + 1,
+			-1, 1, (ptrdiff_t) width - 1, (ptrdiff_t) width,
+			(ptrdiff_t) width + 1 };
+
+		// the kernel of each pixel; pixels on the border are done at once
+		std::fill( counts.begin(), counts.end(), 0 );
+		size_t n = 0;
+		for (uint32_t row = j0; row < j1; row++)
+		{
+			uint32_t *line = out + (size_t) (row - j0) * lineSize * S;
+			if (row == 0 || row == height - 1)
+			{
+				hqxResize<S>( rules, kernels, src, width, height,
+					      line, row, row + 1, nullptr );
+				continue;
+			}
+
+			const size_t i = (size_t) row * width;
+			hqxPixel<S>( rules, kernels, src, i, -(ptrdiff_t) width, width,
+				     0, 1, line, lineSize, nullptr );
+			hqxPixel<S>( rules, kernels, src, i + last, -(ptrdiff_t) width,
+				     width, -1, 0, line + last * S, lineSize, nullptr );
+
+			for (ptrdiff_t col = 1; col < last; col++, n++)
+			{
+				const int pattern = src.pattern( i + col, around );
+				const int tests = hqxTests( rules[pattern].tests, src, i + col,
+							    -(ptrdiff_t) width, width, -1, 1 );
+				keys[n] = pattern * 16 + tests;
+				counts[keys[n] + 1]++;
+			}
+		}
+
+		// a counting sort by kernel, in scan order within each bucket
+		for (int key = 0; key < 256 * 16; key++)
+			counts[key + 1] += counts[key];
+		n = 0;
+		for (uint32_t row = j0; row < j1; row++)
+		{
+			if (row == 0 || row == height - 1)
+				continue;
+			for (ptrdiff_t col = 1; col < last; col++, n++)
+			{
+				const uint32_t slot = counts[keys[n]]++;
+				pixels[slot] = (int32_t) ((row - j0) * width + col);
+				outputs[slot] = (int32_t) ((row - j0) * lineSize * S + col * S);
+			}
+		}
+
+		// counts now holds the end of each bucket
+		uint32_t begin = 0;
+		for (int key = 0; key < 256 * 16; key++)
+		{
+			if (counts[key] > begin)
+				buckets[key]( src.image + start, width, pixels.data() + begin,
+					      outputs.data() + begin, counts[key] - begin,
+					      out, lineSize );
+			begin = counts[key];
+		}
+	}
+}
+
+#endif
+
+// Whether hqx scales in buckets of pixels (see setHqxBuckets).
+bool hqxBucketsEnabled();
+
+/**
+ * @brief Scales the rows rowBegin to rowEnd of a width x height image by
+ * S, with the kernels of Kernels (an HqxKernels): with hqxResizeBuckets,
+ * if buckets are enabled, the processor has AVX2 and there is no cache
+ * (nor are stats being collected), or else with hqxResize.
+ */
+template <int S, class Kernels, class Source>
+void hqxRows( const HqxRules<S * S> *rules, const Source &src,
+	      uint32_t width, uint32_t height, uint32_t *output,
+	      uint32_t rowBegin, uint32_t rowEnd, HqxCache<S> *cache )
+{
+#if defined(__x86_64__) || defined(__i386__)
+	bool buckets = hqxBucketsEnabled() && !cache && cpuLevel() >= CPU_AVX2;
+#ifdef HQX_STATS
+	buckets = buckets && !hqxStatsEnabled();	// only hqxPixel counts
+#endif
+	if (buckets)
+	{
+		hqxResizeBuckets<S>( rules, Kernels::table.data(),
+				     Kernels::buckets.data(), src, width, height,
+				     output, rowBegin, rowEnd );
+		return;
+	}
+#endif
+	hqxResize<S>( rules, Kernels::table.data(), src, width,
+		      height, output, rowBegin, rowEnd, cache );
+}
+
+/**
+ * @brief Prepares a w x h image for scaling, with the thresholds of the
+ * original implementation, and calls rows( src, j0, j1, cache ) for bands
+ * of rows on the thread pool. Images of at most 256 colors are passed as
+ * an HqxPalette, others as HqxPlanes. Each band gets its own cache of
+ * windows scaled by S, if enabled and no stats are being collected.
+ */
+template <int S, char Mode, class Rows>
+void hqxScale( const uint32_t *img, int w, int h, const Rows &rows )
+{
+	// the indices of a palette image take the plane that is the pattern
+	// plane of any other image, so that neither allocates a plane it does
+	// not use; the scan for colors stops early on photos
+	std::vector<uint8_t> indices( (size_t) w * h ), patterns;
+	std::vector<uint32_t> palette( 256 );
+	const int colors = findPalette( img, w, h, palette.data(), indices.data() );
+
+	std::vector<uint32_t> differences, yuv;
+	if (colors > 0)
+	{
+		patterns.resize( (size_t) w * h );
+		differences.resize( 256 * 8 );
+		paletteDifferences( Mode, palette.data(), colors, 0x30, 0x07, 0x06, 0x50,
+				    differences.data() );
+		palettePatterns( indices.data(), differences.data(), w, h,
+				 patterns.data() );
+	}
+	else
+	{
+		indices.swap( patterns );
+		yuv.resize( (size_t) w * h );
+		imageToAYUV( img, w, h, yuv.data() );
+		patternPlane( Mode, img, yuv.data(), w, h, 0x30, 0x07, 0x06, 0x50,
+			      false, false, patterns.data() );
+	}
+
+	const HqxPalette pal = { img, palette.data(), indices.data(),
+				 differences.data(), patterns.data() };
+	const HqxPlanes<Mode> planes( img, yuv.data(), patterns.data(),
+				      0x30, 0x07, 0x06, 0x50 );
+
+	bool useCache = hqxCacheEnabled();
+#ifdef HQX_STATS
+	useCache = useCache && !hqxStatsEnabled();	// hits would go uncounted
+#endif
+
+	parallelFor( 0, h, [&]( int j0, int j1 ) {
+		std::unique_ptr<HqxCache<S>> cache;
+		if (useCache)
+			cache.reset( new HqxCache<S> );
+
+		if (colors > 0)
+			rows( pal, j0, j1, cache.get() );
+		else
+			rows( planes, j0, j1, cache.get() );
+
+		if (cache)
+			hqxCacheCount( cache->lookups, cache->hits );
+	} );
+}
+
+#endif
@@ -32,9 +32,9 @@ void copy( uint32_t *img, int w, int h, uint32_t *out );
 void block2( uint32_t *img, int w, int h, uint32_t *out );
 void block3( uint32_t *img, int w, int h, uint32_t *out );
 void scale2x( uint32_t *img, int W, int H, uint32_t *out );
-void scale2xPad( uint32_t *img, uint16_t W, uint16_t H, uint32_t *out );
+void scale2xPad( uint32_t *img, int W, int H, uint32_t *out );
 void scale2xSFX( uint32_t *img, int w, int h, uint32_t *out );
-void scale3xPad( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out );
-void scale3xSFX( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out );
+void scale3xPad( uint32_t *img, int w, int h, uint32_t *out );
+void scale3xSFX( uint32_t *img, int w, int h, uint32_t *out );
 
 #endif
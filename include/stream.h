@@ -0,0 +1,51 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#ifndef __JANERT_PIXELSCALERS_STREAM__
+#define __JANERT_PIXELSCALERS_STREAM__
+
+#include <cstdint>
+
+#include "bitmap.h"
+
+// A scaling algorithm, as seen by the drivers that run it on parts of an
+// image: the function that scales a (padded) image, the scale factor, the
+// padding the function expects on all four sides of its input, and the
+// support: how many input rows above and below a row influence the output
+// for that row. A support of -1 means the output may depend on all rows.
+struct Scaler {
+  const char *name;
+  void (*scale)( uint32_t *img, int w, int h, uint32_t *out );
+  uint32_t factor;
+  uint16_t padding;
+  int support;
+};
+
+int streamScale( BitmapReader &reader, BitmapWriter &writer,
+		 const Scaler &scaler );
+
+#endif
@@ -0,0 +1,48 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#ifndef __JANERT_PIXELSCALERS_THREADS__
+#define __JANERT_PIXELSCALERS_THREADS__
+
+#include <functional>
+
+// Sets the number of threads used by parallelFor, including the calling
+// thread; 0 selects one thread per processor. The worker threads persist
+// until the count is changed again, or the program exits. The default is
+// a single thread: no workers.
+void setThreadCount( int n );
+int threadCount();
+
+// Splits the range [begin, end) into contiguous chunks, and calls fn once
+// for each chunk, with the chunk's first and one-past-last index. Chunks
+// are handed out to the pool, and to the calling thread, and parallelFor
+// returns once all of them are done. Calls made from within fn run all
+// chunks on the current thread. Must not be called concurrently from
+// several threads outside of the pool.
+void parallelFor( int begin, int end, const std::function<void(int, int)> &fn );
+
+#endif
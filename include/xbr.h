@@ -37,6 +37,43 @@ by Philipp K. Janert, September 2022
 
 void scaleSuperXBR(uint32_t* data, int w, int h, uint32_t* out);
 
+// How the passes of Super-xBR read each other's output. XBR_IN_PLACE, the
+// default, works in place on a single buffer, as the original does: the
+// second and third passes read some of the pixels they have already
+// written, so they run on one thread. XBR_BUFFERED has each pass read
+// only the result of the previous one, from a separate buffer, so that
+// every pass can be split into bands of rows for the threads of
+// parallelFor. Its output is not the original's (in particular, the third
+// pass no longer feeds its own output back in), and it needs more memory.
+// XBR_TILED gives the same output as XBR_BUFFERED, but runs all three
+// passes on one tile of the output at a time, with a halo wide enough for
+// their combined support, in buffers small enough to stay in cache; tiles
+// are handed out to the threads of parallelFor.
+// XBR_FIXED runs the passes as XBR_BUFFERED does, but in fixed point, with
+// integers only, so that its output does not depend on how the compiler
+// treats floating point. From the same samples, a pass finds the same
+// edges as XBR_BUFFERED but at ties, and is then off by at most 1 per
+// channel; over the passes, these differences can make a later pass see
+// an edge differently, and a pixel is then off by as much as the range of
+// the samples around it (see xbr.cc).
+enum XbrMode { XBR_IN_PLACE, XBR_BUFFERED, XBR_TILED, XBR_FIXED };
+void setXbrMode(XbrMode mode);
+
+// The support of scaleSuperXBR in the current mode, as in Scaler: the
+// number of input rows above and below a row that affect its output.
+// XBR_IN_PLACE has none (-1): its second and third passes feed their own
+// output back in, across the whole image. In the other modes, each pass
+// reads the previous one only: the output reads the first pass up to 6
+// output rows (3 input rows) away, as the tiles of XBR_TILED do, and the
+// first pass reads the input up to 2 rows away, so the support is 5.
+int xbrSupport();
+
+// An estimate of the memory traffic of the last call to scaleSuperXBR, in
+// bytes: each pass is counted as reading and writing the planes it sweeps
+// over once. image counts the buffers of the size of the whole input or
+// output, tiles the tile buffers of XBR_TILED, which stay in cache.
+void xbrTraffic(uint64_t &image, uint64_t &tiles);
+
 #endif
 
 
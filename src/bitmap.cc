@@ -17,15 +17,29 @@
  * and modified by Philipp K. Janert, September 2022
  */
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 #include <cstdlib>
+#include <climits>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "bitmap.h"
+#include "cpu.h"
 
-using std::ifstream;
-using std::ofstream;
 using std::string;
 
 #pragma pack(push, 1)
@@ -55,20 +69,305 @@ struct DibHeader
 
 #pragma pack(pop)
 
-// Writes a Windows Bitmap image (BMP3, 24 bits) data structure from raw data
-int saveBitmap(	const uint32_t *data, uint32_t width, uint32_t height,
-		const string &fileName ) {
+// Preferred size of a single write when saving an image
+static const uint32_t stripeBytes = 1 << 20;
+
+// Packs one row of ARGB pixels to BGR24, as stored in the file. The
+// alpha channel is dropped.
+static void encodeRowScalar( const uint32_t *src, uint8_t *dst,
+			     uint32_t width ) {
+	for (uint32_t j = 0; j < width; ++j, dst += 3)
+	{
+		dst[0] = (uint8_t) src[j];
+		dst[1] = (uint8_t) (src[j] >> 8);
+		dst[2] = (uint8_t) (src[j] >> 16);
+	}
+}
+
+// Expands one row of packed BGR24 pixels (as stored in the file) to ARGB,
+// setting the alpha channel to opaque.
+static void decodeRowScalar( const uint8_t *src, uint32_t *dst,
+			     uint32_t width ) {
+	for (uint32_t j = 0; j < width; ++j, src += 3)
+		dst[j] = 0xFF000000 | ((uint32_t) src[2] << 16) |
+			((uint32_t) src[1] << 8) | (uint32_t) src[0];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The SIMD versions move pixels between the 3-byte and 4-byte layouts with
+// byte shuffles. Loads and stores are wider than the pixels they convert,
+// so the vector loops stop early enough to stay inside the row, and the
+// scalar versions finish the row.
+
+__attribute__((target("ssse3")))
+static void encodeRowSSSE3( const uint32_t *src, uint8_t *dst,
+			    uint32_t width ) {
+	const __m128i pack = _mm_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10,
+					    12, 13, 14, -1, -1, -1, -1 );
+	uint32_t j = 0;
+
+	// 4 pixels per step; the 16 byte store needs 6 pixels of room
+	for (; j + 6 <= width; j += 4, dst += 12)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) (src + j) );
+		_mm_storeu_si128( (__m128i*) dst, _mm_shuffle_epi8( v, pack ) );
+	}
+	encodeRowScalar( src + j, dst, width - j );
+}
+
+__attribute__((target("ssse3")))
+static void decodeRowSSSE3( const uint8_t *src, uint32_t *dst,
+			    uint32_t width ) {
+	const __m128i expand = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1,
+					      6, 7, 8, -1, 9, 10, 11, -1 );
+	const __m128i alpha = _mm_set1_epi32( 0xFF000000 );
+	uint32_t j = 0;
+
+	// 4 pixels per step; the 16 byte load needs 6 pixels of room
+	for (; j + 6 <= width; j += 4, src += 12)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) src );
+		v = _mm_or_si128( _mm_shuffle_epi8( v, expand ), alpha );
+		_mm_storeu_si128( (__m128i*) (dst + j), v );
+	}
+	decodeRowScalar( src, dst + j, width - j );
+}
+
+__attribute__((target("avx2")))
+static void encodeRowAVX2( const uint32_t *src, uint8_t *dst,
+			   uint32_t width ) {
+	const __m256i pack = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+	const __m256i join = _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 );
+	uint32_t j = 0;
+
+	// 8 pixels per step; the 32 byte store needs 11 pixels of room
+	for (; j + 11 <= width; j += 8, dst += 24)
+	{
+		__m256i v = _mm256_loadu_si256( (const __m256i*) (src + j) );
+		v = _mm256_permutevar8x32_epi32( _mm256_shuffle_epi8( v, pack ),
+						 join );
+		_mm256_storeu_si256( (__m256i*) dst, v );
+	}
+	encodeRowSSSE3( src + j, dst, width - j );
+}
+
+__attribute__((target("avx2")))
+static void decodeRowAVX2( const uint8_t *src, uint32_t *dst,
+			   uint32_t width ) {
+	const __m256i expand = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+	const __m256i alpha = _mm256_set1_epi32( 0xFF000000 );
+	uint32_t j = 0;
+
+	// 8 pixels per step; the second 16 byte load needs 10 pixels of room
+	for (; j + 10 <= width; j += 8, src += 24)
+	{
+		__m256i v = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(
+				_mm_loadu_si128( (const __m128i*) src ) ),
+			_mm_loadu_si128( (const __m128i*) (src + 12) ), 1 );
+		v = _mm256_or_si256( _mm256_shuffle_epi8( v, expand ), alpha );
+		_mm256_storeu_si256( (__m256i*) (dst + j), v );
+	}
+	decodeRowSSSE3( src, dst + j, width - j );
+}
+
+#endif
+
+typedef void (*EncodeRowFn)( const uint32_t *src, uint8_t *dst,
+			     uint32_t width );
+typedef void (*DecodeRowFn)( const uint8_t *src, uint32_t *dst,
+			     uint32_t width );
+
+// Picks the fastest row converters the processor supports.
+static EncodeRowFn selectEncodeRow() {
+#if defined(__x86_64__) || defined(__i386__)
+	if (cpuLevel() >= CPU_AVX2) return &encodeRowAVX2;
+	if (cpuLevel() >= CPU_SSSE3) return &encodeRowSSSE3;
+#endif
+	return &encodeRowScalar;
+}
+
+static DecodeRowFn selectDecodeRow() {
+#if defined(__x86_64__) || defined(__i386__)
+	if (cpuLevel() >= CPU_AVX2) return &decodeRowAVX2;
+	if (cpuLevel() >= CPU_SSSE3) return &decodeRowSSSE3;
+#endif
+	return &decodeRowScalar;
+}
+
+static const EncodeRowFn encodeRow = selectEncodeRow();
+static const DecodeRowFn decodeRow = selectDecodeRow();
+
+// Size in bytes of one row of pixels in the file, including the suffix
+// that pads each row to a multiple of four bytes. Computed in 64 bits, as
+// 3*width overflows 32 bits for widths that the header can hold.
+static size_t fileRowSize( uint32_t width ) {
+//	suffix = ((width + 3) & ~0x03) - width;      // orig
+//	suffix = ((3*width + 3) & ~0x03) - 3*width;  // corrected
+	uint64_t suffix = ( 4 - (3*(uint64_t) width)%4 )%4;     // pkj
+	return 3*(uint64_t) width + suffix;
+}
+
+// Largest width or height accepted from a file. Scaled by up to 4, it
+// still fits into an int. Top-down images store a negative height, which
+// reads as far larger than this, and are rejected as well.
+static const uint32_t maxDimension = INT32_MAX / 4;
+
+// Validates the file and DIB headers, and extracts the image size.
+static int checkHeaders( const BitmapHeader &bh, const DibHeader &dh,
+			 uint32_t &width, uint32_t &height ) {
+	if (bh.bfType != 0x4D42) return -1;
+	if (dh.biSize != 40) return -2;
+
+	width  = dh.biWidth;
+	height = dh.biHeight;
+	if (dh.biBitCount != 24) return -3;
+	if (width == 0 || height == 0) return -5;
+	if (width > maxDimension || height > maxDimension) return -5;
+
+	// The pixel data in the file, and the image scaled by 4 in memory,
+	// must both be addressable
+	const uint64_t offBits = sizeof(BitmapHeader) + sizeof(DibHeader);
+	if ((uint64_t) fileRowSize( width ) * height > SIZE_MAX - offBits)
+		return -5;
+	if ((uint64_t) width * height > SIZE_MAX / (16 * sizeof(uint32_t)))
+		return -5;
+
+	return 0;
+}
+
+BitmapReader::BitmapReader()
+	: input(NULL), map(NULL), next(NULL), mapSize(0),
+	  rowSize(0), rowsLeft(0), w(0), h(0) {}
+
+BitmapReader::~BitmapReader() {
+#if defined(__unix__) || defined(__APPLE__)
+	if (map) munmap( (void*) map, mapSize );
+#endif
+}
+
+// Opens the file and reads its headers. Regular files are mapped into
+// memory, and their headers are validated in place; rows are later
+// decoded straight from the mapping, without intermediate buffering.
+int BitmapReader::open( const string &fileName ) {
+	const size_t offBits = sizeof(BitmapHeader) + sizeof(DibHeader);
+
+#if defined(__unix__) || defined(__APPLE__)
+	int fd = fileName == "-" ? -1 : ::open( fileName.c_str(), O_RDONLY );
+	if (fd >= 0)
+	{
+		struct stat st;
+		void *addr = MAP_FAILED;
+		if (fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0)
+			addr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		::close( fd );
+
+		if (addr != MAP_FAILED)
+		{
+			map = (const uint8_t*) addr;
+			mapSize = st.st_size;
+			madvise( addr, mapSize, MADV_SEQUENTIAL );
+
+			if (mapSize < offBits) return -1;
+			int res = checkHeaders( *(const BitmapHeader*) map,
+						*(const DibHeader*) (map + sizeof(BitmapHeader)),
+						w, h );
+			if (res) return res;
+
+			rowSize = fileRowSize( w );
+			rowsLeft = h;
+			next = map + offBits;
+			if (mapSize < offBits + rowSize * h) return -4;
+			return 0;
+		}
+	}
+#endif
+
+	// Not mappable (a pipe, say): read the file as a stream
+	if (fileName == "-")
+		input = &std::cin;
+	else
+	{
+		file.open( fileName.c_str(), std::ios_base::binary );
+		if (!file.good()) return -1;
+		input = &file;
+	}
+
+	BitmapHeader bh;
+	DibHeader dh;
+	input->read( (char*) &bh, sizeof(BitmapHeader) );
+	input->read( (char*) &dh, sizeof(DibHeader) );
+	if (!*input) return -1;
+	if (int res = checkHeaders( bh, dh, w, h )) return res;
+
+	rowSize = fileRowSize( w );
+	rowsLeft = h;
+	buffer.resize( rowSize );
+	return 0;
+}
+
+// Decodes the next row of the file into row, which must have room for
+// width() pixels. Streams are read with one call per row.
+int BitmapReader::readRow( uint32_t *row ) {
+	if (rowsLeft == 0) return -4;
+
+	if (map)
+	{
+		decodeRow( next, row, w );
+		next += rowSize;
+	}
+	else
+	{
+		if (!input || !input->read( (char*) buffer.data(), rowSize ))
+			return -4;
+		decodeRow( buffer.data(), row, w );
+	}
+
+	rowsLeft--;
+	return 0;
+}
+
+// Decodes count pixels of image row y (counted from the top, unlike the
+// order of rows in the file), starting at column x, into dst. Only
+// possible for files that are mapped into memory.
+int BitmapReader::readSpan( uint32_t y, uint32_t x, uint32_t count,
+			    uint32_t *dst ) {
+	if (!map) return -5;
+	if (y >= h || x > w || count > w - x) return -4;
+
+	const size_t offBits = sizeof(BitmapHeader) + sizeof(DibHeader);
+	decodeRow( map + offBits + (h - 1 - y) * rowSize + 3*(size_t) x,
+		   dst, count );
+	return 0;
+}
+
+BitmapWriter::BitmapWriter()
+	: output(NULL), w(0), h(0), rowSize(0), stripeRows(0), pending(0),
+	  sized(false) {}
+
+// Creates the file and writes its headers.
+int BitmapWriter::open( const string &fileName,
+			uint32_t width, uint32_t height ) {
 	BitmapHeader bh;
 	DibHeader dh;
-	uint16_t suffix;
-	uint32_t zero = 0;
-	const uint32_t *ptr;
+	uint64_t suffix;
 
-	ofstream output(fileName.c_str(), std::ios_base::binary);	
-	if (!output.good()) return -1;
+	if (fileName == "-")
+		output = &std::cout;
+	else
+	{
+		file.open( fileName.c_str(), std::ios_base::binary );
+		if (!file.good()) return -1;
+		output = &file;
+	}
 
 	// suffix = ((width + 3) & ~0x03) - width;
-	suffix = ( 4 - (3*width)%4 )%4;
+	suffix = ( 4 - (3*(uint64_t) width)%4 )%4;
 	
 	dh.biSize          = sizeof(DibHeader);
 	dh.biWidth         = width;
@@ -77,81 +376,141 @@ int saveBitmap(	const uint32_t *data, uint32_t width, uint32_t height,
 	dh.biBitCount      = 24;
 	dh.biCompression   = 0;
 	// dh.biSizeImage     = (uint16_t) ( (width*3+suffix)*height );
-	dh.biSizeImage     = (width*3+suffix)*height;
+	// Sizes that do not fit into the 32 bit fields are given as 0, which
+	// readers accept for uncompressed images (and ignore in practice).
+	uint64_t imageSize = ((uint64_t) width*3+suffix)*height;
+	dh.biSizeImage     = imageSize + 0x0036 <= UINT32_MAX ? imageSize : 0;
 	dh.biXPelsPerMeter = 0x2E23;
 	dh.biYPelsPerMeter = dh.biXPelsPerMeter;
 	dh.biClrUsed       = 0;
 	dh.biClrImportant  = 0;
 
 	bh.bfType    = 0x4D42;
-	bh.bfSize    = dh.biSizeImage + 0x0036;
+	bh.bfSize    = dh.biSizeImage > 0 ? dh.biSizeImage + 0x0036 : 0;
 	bh.bfRes1    = 0;
 	bh.bfOffBits = 0x0036;
-	output.write( (char*) &bh, sizeof(BitmapHeader) );
-	output.write( (char*) &dh, sizeof(DibHeader) );
+	output->write( (char*) &bh, sizeof(BitmapHeader) );
+	output->write( (char*) &dh, sizeof(DibHeader) );
+
+	// The suffix bytes of every row in the stripe are never touched after
+	// the buffer has been zero-initialized.
+	w = width;
+	h = height;
+	rowSize = 3*(uint64_t) width + suffix;
+	stripeRows = rowSize > 0 ? std::max<size_t>( 1, stripeBytes / rowSize ) : 1;
+	stripe.assign( (size_t) stripeRows * rowSize, 0 );
+	pending = 0;
+
+	return output->good() ? 0 : -2;
+}
 
-	ptr = data + (width * height);
-	for (uint32_t i = 0; i < height; i++)
+// Packs the row into the stripe buffer, and writes out the stripe once it
+// is full.
+int BitmapWriter::writeRow( const uint32_t *row ) {
+	encodeRow( row, stripe.data() + pending*rowSize, w );
+	if (++pending == stripeRows)
 	{
-		ptr -= width;
+		output->write( (char*) stripe.data(), pending*rowSize );
+		pending = 0;
+	}
+	return output->good() ? 0 : -2;
+}
 
-		for (uint32_t j = 0; j < width; ++j)
-			output.write( (char*) (ptr + j), 3 );
+// Packs count pixels from src into row y of the image (counted from the
+// top, unlike the order of rows in the file), starting at column x. The
+// first call extends the file to its full size, so that the row suffixes,
+// which are never written, read as zeros.
+int BitmapWriter::writeSpan( uint32_t y, uint32_t x, uint32_t count,
+			     const uint32_t *src ) {
+	const uint64_t offBits = sizeof(BitmapHeader) + sizeof(DibHeader);
 
-		if (suffix > 0)
-			output.write( (char*) &zero, suffix );
-	}
+	if (!file.is_open()) return -5;
+	if (y >= h || x > w || count > w - x) return -4;
 
-	output.close();
+	if (!sized && h > 0 && rowSize > 0)
+	{
+		char zero = 0;
+		file.seekp( offBits + (uint64_t) h * rowSize - 1 );
+		file.write( &zero, 1 );
+		sized = true;
+	}
 
-  return 0;
+	span.resize( 3*(size_t) count );
+	encodeRow( src, span.data(), count );
+	file.seekp( offBits + (uint64_t) (h - 1 - y) * rowSize + 3*(uint64_t) x );
+	file.write( (char*) span.data(), span.size() );
+	return file.good() ? 0 : -2;
 }
 
-// Allocates memory for and loads an Windows Bitmap image (BMP3, 24 bits)
-int loadBitmap(	const string &fileName, uint32_t *&data,
-		uint16_t &width, uint16_t &height ) {
-	BitmapHeader bh;
-	DibHeader dh;
-	uint16_t suffix;
-	uint32_t zero = 0;
-	uint32_t *ptr;
-	uint16_t bits;
-
-	ifstream input(fileName.c_str(), std::ios_base::binary);
-	if (!input.good()) return -1;
+// Writes out all pending rows, and passes them on to the file or pipe.
+int BitmapWriter::flush() {
+	if (pending > 0)
+		output->write( (char*) stripe.data(), pending*rowSize );
+	pending = 0;
+	output->flush();
+	return output->good() ? 0 : -2;
+}
 
-	input.read( (char*) &bh, sizeof(BitmapHeader) );
-	if (bh.bfType != 0x4D42) return -1;
-	input.read( (char*) &dh.biSize, sizeof(uint32_t) );
-	if (dh.biSize != 40) return -2;
+int BitmapWriter::close() {
+	int res = flush();
+	if (file.is_open())
+	{
+		file.close();
+		if (!file) res = -2;
+	}
+	return res;
+}
 
-	input.read( (char*) &dh.biWidth, sizeof(DibHeader) - sizeof(uint32_t) );
-	width  = dh.biWidth;
-	height = dh.biHeight;
-	if (dh.biBitCount != 24) return -3;
+// Writes a Windows Bitmap image (BMP3, 24 bits) data structure from raw data
+int saveBitmap(	const uint32_t *data, uint32_t width, uint32_t height,
+		const string &fileName ) {
+	BitmapWriter writer;
+	if (int res = writer.open( fileName, width, height )) return res;
 
-	// suffix = ((width + 3) & ~0x03) - width;
-	suffix = ( 4 - (3*width)%4 )%4;
-	ptr = data = new uint32_t[width * height]();
-	ptr += width * height;
+	const uint32_t *ptr = data + (size_t) width * height;
 	for (uint32_t i = 0; i < height; i++)
 	{
 		ptr -= width;
+		if (int res = writer.writeRow( ptr )) return res;
+	}
+
+	return writer.close();
+}
+
+// Allocates memory for the image plus "pad" pixels on all four sides, and
+// loads the image into the inner part.
+static int loadPixels( const string &fileName, uint32_t *&data,
+		       uint32_t &width, uint32_t &height, uint16_t pad ) {
+	BitmapReader reader;
+	if (int res = reader.open( fileName )) return res;
+
+	width = reader.width();
+	height = reader.height();
+	size_t stride = width + 2*pad;
+	data = new uint32_t[stride * (height + 2*pad)];
 
-		for (uint32_t j = 0; j < width; ++j)
+	// Rows are stored bottom-up in the file
+	uint32_t *ptr = data + (pad + height) * stride + pad;
+	for (uint32_t i = 0; i < height; i++)
+	{
+		ptr -= stride;
+		if (int res = reader.readRow( ptr ))
 		{
-			input.read( (char*) (ptr + j), 3 );
-			*(ptr + j) |= 0xFF000000;
+			delete[] data;
+			data = NULL;
+			return res;
 		}
-
-		if (suffix > 0)
-			input.read( (char*) &zero, suffix );
 	}
 
-	input.close();
 	return 0;
 }
 
+// Allocates memory for and loads an Windows Bitmap image (BMP3, 24 bits)
+int loadBitmap(	const string &fileName, uint32_t *&data,
+		uint32_t &width, uint32_t &height ) {
+	return loadPixels( fileName, data, width, height, 0 );
+}
+
 // Like loadBitmap(), but allocates "pad" pixels on all four sides, and fills
 // them with the nearest pixel values. This greatly simplifies edge handling
 // in the scaling algos. The only place to add the padding is when the data
@@ -159,56 +518,17 @@ int loadBitmap(	const string &fileName, uint32_t *&data,
 // width+2*pad, height+2*pad. This is not separately reported, client code
 // is responsible for providing to algos a data struct w/ required padding.
 int loadBitmapPadded( const string &fileName, uint32_t *&data,
-		      uint16_t &width, uint16_t &height, uint16_t pad ) {
-	BitmapHeader bh;
-	DibHeader dh;
-	uint16_t suffix;
-	uint32_t zero = 0;
-	uint32_t *ptr;
-	uint16_t bits;
+		      uint32_t &width, uint32_t &height, uint16_t pad ) {
+	size_t fullWidth, origin;
 
-	uint16_t fullWidth, fullHeight, origin;
-	
-	ifstream input(fileName.c_str(), std::ios_base::binary);
-	if (!input.good()) return -1;
-
-	input.read( (char*) &bh, sizeof(BitmapHeader) );
-	if (bh.bfType != 0x4D42) return -1;
-	input.read( (char*) &dh.biSize, sizeof(uint32_t) );
-	if (dh.biSize != 40) return -2;
-
-	input.read( (char*) &dh.biWidth, sizeof(DibHeader) - sizeof(uint32_t) );
-	width  = dh.biWidth;
-	height = dh.biHeight;
-	if (dh.biBitCount != 24) return -3;
-
-//	suffix = ((width + 3) & ~0x03) - width;      // orig
-//	suffix = ((3*width + 3) & ~0x03) - 3*width;  // corrected
-	suffix = ( 4 - (3*width)%4 )%4;              // pkj
+	if (int res = loadPixels( fileName, data, width, height, pad ))
+		return res;
 
 	fullWidth = width + 2*pad;
-	fullHeight = height + 2*pad;
-	
-	ptr = data = new uint32_t[fullWidth*fullHeight]();
-	ptr += pad + (pad+height)*fullWidth;
-	
-	for (uint32_t i = 0; i < height; i++) {
-  	        ptr -= fullWidth;
-
-		for (uint32_t j = 0; j < width; ++j) {
-			input.read( (char*) (ptr + j), 3 );
-			*(ptr + j) |= 0xFF000000;
-		}
-
-		if (suffix > 0) {
-			input.read( (char*) &zero, suffix );
-		}
-	}
-	input.close();
 
 	// Top and bottom padding
-	for( int i=0; i<width; i++ ) {
-	  for( int j=0; j<pad; j++ ) {
+	for( uint32_t i=0; i<width; i++ ) {
+	  for( uint32_t j=0; j<pad; j++ ) {
 	    data[j*fullWidth + pad + i] = data[pad*fullWidth + pad + i];
 	    data[(pad+height+j)*fullWidth + pad + i] =
 	      data[(pad+height-1)*fullWidth + pad + i];
@@ -216,8 +536,8 @@ int loadBitmapPadded( const string &fileName, uint32_t *&data,
 	}
 
 	// Left and right padding
-	for( int i=0; i<height; i++ ) {
-	  for( int j=0; j<pad; j++ ) {
+	for( uint32_t i=0; i<height; i++ ) {
+	  for( uint32_t j=0; j<pad; j++ ) {
 	    data[(pad+i)*fullWidth + j] = data[(pad+i)*fullWidth + pad];
 	    data[(pad+i)*fullWidth + pad + width + j] =
 	      data[(pad+i)*fullWidth + pad + width - 1];
@@ -225,8 +545,8 @@ int loadBitmapPadded( const string &fileName, uint32_t *&data,
 	}
 
 	// Corner padding
-	for( int i=0; i<pad; i++ ) {
-	  for( int j=0; j<pad; j++ ) {
+	for( uint32_t i=0; i<pad; i++ ) {
+	  for( uint32_t j=0; j<pad; j++ ) {
 	    origin = 0;
 	    data[origin + i*fullWidth + j] = data[pad*fullWidth + pad];
 
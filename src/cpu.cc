@@ -0,0 +1,67 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#include <cstdlib>
+#include <string>
+
+#include "cpu.h"
+
+static CpuLevel detectCpuLevel() {
+  CpuLevel level = CPU_SCALAR;
+
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "ssse3" ) ) {
+    level = CPU_SSSE3;
+    if( __builtin_cpu_supports( "avx2" ) ) {
+      level = CPU_AVX2;
+      if( __builtin_cpu_supports( "avx512f" ) &&
+	  __builtin_cpu_supports( "avx512bw" ) ) {
+	level = CPU_AVX512;
+      }
+    }
+  }
+#endif
+
+  const char *env = std::getenv( "PIXELSCALER_SIMD" );
+  if( env ) {
+    std::string cap = env;
+    CpuLevel limit = level;
+    if(      cap == "scalar" ) { limit = CPU_SCALAR; }
+    else if( cap == "ssse3" )  { limit = CPU_SSSE3; }
+    else if( cap == "avx2" )   { limit = CPU_AVX2; }
+    else if( cap == "avx512" ) { limit = CPU_AVX512; }
+    if( limit < level ) { level = limit; }
+  }
+
+  return level;
+}
+
+CpuLevel cpuLevel() {
+  static const CpuLevel level = detectCpuLevel();
+  return level;
+}
@@ -17,2468 +17,822 @@
  * and modified by Philipp K. Janert, September 2022
  */
 
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
 #include "hqx.h"
 #include "hqx1.h"
+#include "threads.h"
 
-// Public wrapper functions at end of source file!
-
-uint32_t *hq2x_resize(
-	char mode,	     
-	const uint32_t *image,
-	uint32_t width,
-	uint32_t height,
-	uint32_t *output,
-	uint32_t trY,
-	uint32_t trU,
-	uint32_t trV,
-	uint32_t trA,
-	bool wrapX,
-	bool wrapY )
-{
-        bool (*isDifferent)( uint32_t color1, uint32_t color2,
-			     uint32_t trY, uint32_t trU,
-			     uint32_t trV, uint32_t trA ) = &isDifferentA;
-	if( mode == 'B' ) {
-	  isDifferent = &isDifferentB;
-	}	
-  
-	int lineSize = width * 2;
-
-	int previous, next;
-	uint32_t w[9];
-
-	trY <<= 16;
-	trU <<= 8;
-	trA <<= 24;
-
-	// iterates between the lines
-	for (uint32_t row = 0; row < height; row++)
-	{
-		/*
-		 * Note: this function uses a 3x3 sliding window over the original image.
-		 *
-		 *   +----+----+----+
-		 *   |    |    |    |
-		 *   | w0 | w1 | w2 |
-		 *   +----+----+----+
-		 *   |    |    |    |
-		 *   | w3 | w4 | w5 |
-		 *   +----+----+----+
-		 *   |    |    |    |
-		 *   | w6 | w7 | w8 |
-		 *   +----+----+----+
-		 */
-
-		// adjusts the previous and next line pointers
-		if (row > 0)
-			previous = -width;
-		else
-		{
-			if (wrapY)
-				previous = width * (height - 1);
-			else
-				previous = 0;
-		}
-		if (row < height - 1)
-			next = width;
-		else
-		{
-			if (wrapY)
-				next = -(width * (height - 1));
-			else
-				next = 0;
-		}
-
-		// iterates between the columns
-		for (uint32_t col = 0; col < width; col++)
-		{
-			w[1] = *(image + previous);
-			w[4] = *image;
-			w[7] = *(image + next);
-
-			if (col > 0)
-			{
-				w[0] = *(image + previous - 1);
-				w[3] = *(image - 1);
-				w[6] = *(image + next - 1);
-			}
-			else
-			{
-				if (wrapX)
-				{
-					w[0] = *(image + previous + width - 1);
-					w[3] = *(image + width - 1);
-					w[6] = *(image + next + width - 1);
-				}
-				else
-				{
-					w[0] = w[1];
-					w[3] = w[4];
-					w[6] = w[7];
-				}
-			}
-
-			if (col < width - 1)
-			{
-				w[2] = *(image + previous + 1);
-				w[5] = *(image + 1);
-				w[8] = *(image + next + 1);
-			}
-			else
-			{
-				if (wrapX)
-				{
-					w[2] = *(image + previous - width + 1);
-					w[5] = *(image - width + 1);
-					w[8] = *(image + next - width + 1);
-				}
-				else
-				{
-					w[2] = w[1];
-					w[5] = w[4];
-					w[8] = w[7];
-				}
-			}
+// The rules for each pattern: the tie-break tests they depend on, and
+// for each output sub-pixel, left to right and top to bottom, the blend
+// of the window to use. TEST(t, d, s) uses blend d if test t finds a
+// difference, and blend s otherwise. The rules were derived from the
+// switch statement of the original implementation, case by case.
 
-			int pattern = 0;
+#define USE(m)		{ T_NONE, m, m }
+#define TEST(t, d, s)	{ t, d, s }
 
-			// computes the pattern to be used considering the neighbor pixels
-			for (int k = 0, flag = 1; k < 9; k++)
-			{
-				// ignores the central pixel
-				if (k == 4) continue;
+static constexpr HqxRules<4> rules[256] = {
+	/*   0 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   1 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   2 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   3 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   4 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   5 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   6 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   7 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   8 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*   9 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  10 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  11 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  12 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  13 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  14 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_3_3), TEST(T_31, M_4_5_3_1, M_4_1_5_5_2_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  15 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), TEST(T_31, M_4_5_3_1, M_4_1_5_5_2_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  16 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  17 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  18 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  19 */ { 1 << T_15,
+		{ TEST(T_15, M_4_3_3_1, M_4_1_3_5_2_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  20 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  21 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  22 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  23 */ { 1 << T_15,
+		{ TEST(T_15, M_4_3_3_1, M_4_1_3_5_2_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  24 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  25 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  26 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  27 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  28 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  29 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  30 */ { 1 << T_15,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  31 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  32 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  33 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  34 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  35 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  36 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  37 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  38 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  39 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/*  40 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  41 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  42 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_3_3), USE(M_4_2_5_2_1_1),
+		  TEST(T_31, M_4_7_3_1, M_4_3_7_5_2_1), USE(M_4_5_7_2_1_1) } },
+	/*  43 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), USE(M_4_2_5_2_1_1),
+		  TEST(T_31, M_4_7_3_1, M_4_3_7_5_2_1), USE(M_4_5_7_2_1_1) } },
+	/*  44 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  45 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  46 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  47 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/*  48 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  49 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  50 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  51 */ { 1 << T_15,
+		{ TEST(T_15, M_4_3_3_1, M_4_1_3_5_2_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  52 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  53 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  54 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  55 */ { 1 << T_15,
+		{ TEST(T_15, M_4_3_3_1, M_4_1_3_5_2_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), USE(M_4_8_7_2_1_1) } },
+	/*  56 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  57 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  58 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  59 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  60 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  61 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  62 */ { 1 << T_15,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  63 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_8_7_2_1_1) } },
+	/*  64 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  65 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  66 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  67 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  68 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  69 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  70 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  71 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  72 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  73 */ { 1 << T_73,
+		{ TEST(T_73, M_4_1_3_1, M_4_3_1_5_2_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_3_3), USE(M_4_8_5_2_1_1) } },
+	/*  74 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  75 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_1), USE(M_4_8_5_2_1_1) } },
+	/*  76 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  77 */ { 1 << T_73,
+		{ TEST(T_73, M_4_1_3_1, M_4_3_1_5_2_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_3_3), USE(M_4_8_5_2_1_1) } },
+	/*  78 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  79 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_8_5_2_1_1) } },
+	/*  80 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_1_1) } },
+	/*  81 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_1_1) } },
+	/*  82 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/*  83 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  84 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), TEST(T_57, M_4_1_3_1, M_4_5_1_5_2_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_3_3) } },
+	/*  85 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), TEST(T_57, M_4_1_3_1, M_4_5_1_5_2_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_3_3) } },
+	/*  86 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_8_3_1) } },
+	/*  87 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  88 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/*  89 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  90 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  91 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  92 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  93 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  94 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/*  95 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_1), USE(M_4_8_3_1) } },
+	/*  96 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/*  97 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/*  98 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/*  99 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/* 100 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/* 101 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/* 102 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/* 103 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_3_3_1), USE(M_4_8_5_2_1_1) } },
+	/* 104 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 105 */ { 1 << T_73,
+		{ TEST(T_73, M_4_1_3_1, M_4_3_1_5_2_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), USE(M_4_8_5_2_1_1) } },
+	/* 106 */ { 1 << T_73,
+		{ USE(M_4_0_3_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 107 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 108 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 109 */ { 1 << T_73,
+		{ TEST(T_73, M_4_1_3_1, M_4_3_1_5_2_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), USE(M_4_8_5_2_1_1) } },
+	/* 110 */ { 1 << T_73,
+		{ USE(M_4_0_3_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 111 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_5_2_1_1) } },
+	/* 112 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_57, M_4_3_3_1, M_4_7_3_5_2_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_3_3) } },
+	/* 113 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_57, M_4_3_3_1, M_4_7_3_5_2_1), TEST(T_57, M_4_8_3_1, M_4_5_7_2_3_3) } },
+	/* 114 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 115 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 116 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 117 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 118 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_8_3_1) } },
+	/* 119 */ { 1 << T_15,
+		{ TEST(T_15, M_4_3_3_1, M_4_1_3_5_2_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_3_3_1), USE(M_4_8_3_1) } },
+	/* 120 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_3_1) } },
+	/* 121 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 122 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4_8_3_1, M_4_5_7_6_1_1) } },
+	/* 123 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_3_1) } },
+	/* 124 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_3_1) } },
+	/* 125 */ { 1 << T_73,
+		{ TEST(T_73, M_4_1_3_1, M_4_3_1_5_2_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), USE(M_4_8_3_1) } },
+	/* 126 */ { 1 << T_15 | 1 << T_73,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_3_1) } },
+	/* 127 */ { 1 << T_15 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_8_3_1) } },
+	/* 128 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 129 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 130 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 131 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 132 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 133 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 134 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 135 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 136 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 137 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 138 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 139 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 140 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 141 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 142 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_3_3), TEST(T_31, M_4_5_3_1, M_4_1_5_5_2_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 143 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), TEST(T_31, M_4_5_3_1, M_4_1_5_5_2_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 144 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 145 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 146 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), TEST(T_15, M_4_7_3_1, M_4_5_7_5_2_1) } },
+	/* 147 */ { 1 << T_15,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 148 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 149 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 150 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), TEST(T_15, M_4_7_3_1, M_4_5_7_5_2_1) } },
+	/* 151 */ { 1 << T_15,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 152 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 153 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 154 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 155 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 156 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 157 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 158 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 159 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_6_7_2_1_1), USE(M_4_7_3_1) } },
+	/* 160 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 161 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 162 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 163 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 164 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 165 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 166 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 167 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_5_7_2_1_1) } },
+	/* 168 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 169 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 170 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_2_3_3), USE(M_4_2_5_2_1_1),
+		  TEST(T_31, M_4_7_3_1, M_4_3_7_5_2_1), USE(M_4_5_7_2_1_1) } },
+	/* 171 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), USE(M_4_2_5_2_1_1),
+		  TEST(T_31, M_4_7_3_1, M_4_3_7_5_2_1), USE(M_4_5_7_2_1_1) } },
+	/* 172 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 173 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 174 */ { 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 175 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), USE(M_4_5_3_1),
+		  USE(M_4_7_3_1), USE(M_4_5_7_2_1_1) } },
+	/* 176 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 177 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 178 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), TEST(T_15, M_4_7_3_1, M_4_5_7_5_2_1) } },
+	/* 179 */ { 1 << T_15,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 180 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 181 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 182 */ { 1 << T_15,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_2_1_1), TEST(T_15, M_4_7_3_1, M_4_5_7_5_2_1) } },
+	/* 183 */ { 1 << T_15,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_7_3_2_1_1), USE(M_4_7_3_1) } },
+	/* 184 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 185 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 186 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 187 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), USE(M_4_2_3_1),
+		  TEST(T_31, M_4_7_3_1, M_4_3_7_5_2_1), USE(M_4_7_3_1) } },
+	/* 188 */ { 0,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 189 */ { 0,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 190 */ { 1 << T_15,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_3_3),
+		  USE(M_4_7_3_1), TEST(T_15, M_4_7_3_1, M_4_5_7_5_2_1) } },
+	/* 191 */ { 1 << T_15 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_7_3_1), USE(M_4_7_3_1) } },
+	/* 192 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 193 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 194 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 195 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 196 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 197 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 198 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 199 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_6_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 200 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_3_3), TEST(T_73, M_4_5_3_1, M_4_7_5_5_2_1) } },
+	/* 201 */ { 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_5_3_1) } },
+	/* 202 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_5_3_1) } },
+	/* 203 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_6_3_1), USE(M_4_5_3_1) } },
+	/* 204 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_2_3_3), TEST(T_73, M_4_5_3_1, M_4_7_5_5_2_1) } },
+	/* 205 */ { 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_5_3_1) } },
+	/* 206 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), USE(M_4_5_3_1) } },
+	/* 207 */ { 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_3_3), TEST(T_31, M_4_5_3_1, M_4_1_5_5_2_1),
+		  USE(M_4_6_3_1), USE(M_4_5_3_1) } },
+	/* 208 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 209 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 210 */ { 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_3_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 211 */ { 1 << T_57,
+		{ USE(M_4_3_3_1), USE(M_4_2_3_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 212 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), TEST(T_57, M_4_1_3_1, M_4_5_1_5_2_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 213 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), TEST(T_57, M_4_1_3_1, M_4_5_1_5_2_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 214 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 215 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_6_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 216 */ { 1 << T_57,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 217 */ { 1 << T_57,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 218 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 219 */ { 1 << T_57 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_3_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 220 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4_6_3_1, M_4_7_3_6_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 221 */ { 1 << T_57,
+		{ USE(M_4_1_3_1), TEST(T_57, M_4_1_3_1, M_4_5_1_5_2_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 222 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 223 */ { 1 << T_15 | 1 << T_57 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_6_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 224 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 225 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 226 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 227 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_2_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 228 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 229 */ { 0,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 230 */ { 0,
+		{ USE(M_4_0_3_2_1_1), USE(M_4_5_3_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 231 */ { 0,
+		{ USE(M_4_3_3_1), USE(M_4_5_3_1),
+		  USE(M_4_3_3_1), USE(M_4_5_3_1) } },
+	/* 232 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), TEST(T_73, M_4_5_3_1, M_4_7_5_5_2_1) } },
+	/* 233 */ { 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), USE(M_4_5_3_1) } },
+	/* 234 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4_0_3_1, M_4_3_1_6_1_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), USE(M_4_5_3_1) } },
+	/* 235 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), USE(M_4_5_3_1) } },
+	/* 236 */ { 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), TEST(T_73, M_4_5_3_1, M_4_7_5_5_2_1) } },
+	/* 237 */ { 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), USE(M_4_5_3_1) } },
+	/* 238 */ { 1 << T_73,
+		{ USE(M_4_0_3_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_3_3), TEST(T_73, M_4_5_3_1, M_4_7_5_5_2_1) } },
+	/* 239 */ { 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), USE(M_4_5_3_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), USE(M_4_5_3_1) } },
+	/* 240 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_57, M_4_3_3_1, M_4_7_3_5_2_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 241 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_57, M_4_3_3_1, M_4_7_3_5_2_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 242 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4_2_3_1, M_4_1_5_6_1_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 243 */ { 1 << T_57,
+		{ USE(M_4_3_3_1), USE(M_4_2_3_1),
+		  TEST(T_57, M_4_3_3_1, M_4_7_3_5_2_1), TEST(T_57, M_4, M_4_5_7_2_3_3) } },
+	/* 244 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 245 */ { 1 << T_57,
+		{ USE(M_4_3_1_2_1_1), USE(M_4_1_3_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 246 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_0_3_2_1_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 247 */ { 1 << T_15 | 1 << T_57,
+		{ USE(M_4_3_3_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  USE(M_4_3_3_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 248 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 249 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_2_1_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 250 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_3_1), USE(M_4_2_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 251 */ { 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_2_1_1), USE(M_4_2_3_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), TEST(T_57, M_4, M_4_5_7_2_1_1) } },
+	/* 252 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_1_2_1_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 253 */ { 1 << T_57 | 1 << T_73,
+		{ USE(M_4_1_3_1), USE(M_4_1_3_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 254 */ { 1 << T_15 | 1 << T_57 | 1 << T_73,
+		{ USE(M_4_0_3_1), TEST(T_15, M_4, M_4_1_5_2_1_1),
+		  TEST(T_73, M_4, M_4_7_3_2_1_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+	/* 255 */ { 1 << T_15 | 1 << T_57 | 1 << T_73 | 1 << T_31,
+		{ TEST(T_31, M_4, M_4_3_1_e_1_1), TEST(T_15, M_4, M_4_1_5_e_1_1),
+		  TEST(T_73, M_4, M_4_7_3_e_1_1), TEST(T_57, M_4, M_4_5_7_e_1_1) } },
+};
 
-				if (w[k] != w[4])
-					if (isDifferent(w[4], w[k], trY, trU, trV, trA)) pattern |= flag;
-				flag <<= 1;
-			}
-
-			switch (pattern)
-			{
-				case 0:
-				case 1:
-				case 4:
-				case 32:
-				case 128:
-				case 5:
-				case 132:
-				case 160:
-				case 33:
-				case 129:
-				case 36:
-				case 133:
-				case 164:
-				case 161:
-				case 37:
-				case 165:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 2:
-				case 34:
-				case 130:
-				case 162:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 16:
-				case 17:
-				case 48:
-				case 49:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 64:
-				case 65:
-				case 68:
-				case 69:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 8:
-				case 12:
-				case 136:
-				case 140:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 3:
-				case 35:
-				case 131:
-				case 163:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 6:
-				case 38:
-				case 134:
-				case 166:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_5_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 20:
-				case 21:
-				case 52:
-				case 53:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 144:
-				case 145:
-				case 176:
-				case 177:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 192:
-				case 193:
-				case 196:
-				case 197:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_5_3_1
-					break;
-				case 96:
-				case 97:
-				case 100:
-				case 101:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 40:
-				case 44:
-				case 168:
-				case 172:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 9:
-				case 13:
-				case 137:
-				case 141:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 18:
-				case 50:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 80:
-				case 81:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 72:
-				case 76:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 10:
-				case 138:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 66:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 24:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 7:
-				case 39:
-				case 135:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 148:
-				case 149:
-				case 180:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 224:
-				case 228:
-				case 225:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 41:
-				case 169:
-				case 45:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 22:
-				case 54:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 208:
-				case 209:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 104:
-				case 108:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 11:
-				case 139:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 19:
-				case 51:
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_00_4_3_3_1
-					MIX_01_4_2_3_1
-					}
-					else
-					{
-					MIX_00_4_1_3_5_2_1
-					MIX_01_4_1_5_2_3_3
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 146:
-				case 178:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_01_4_2_3_1
-					MIX_11_4_7_3_1
-					}
-					else
-					{
-					MIX_01_4_1_5_2_3_3
-					MIX_11_4_5_7_5_2_1
-					}
-					MIX_10_4_7_3_2_1_1
-					break;
-				case 84:
-				case 85:
-					MIX_00_4_3_1_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_01_4_1_3_1
-					MIX_11_4_8_3_1
-					}
-					else
-					{
-					MIX_01_4_5_1_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					MIX_10_4_6_3_2_1_1
-					break;
-				case 112:
-				case 113:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_10_4_3_3_1
-					MIX_11_4_8_3_1
-					}
-					else
-					{
-					MIX_10_4_7_3_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					break;
-				case 200:
-				case 204:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_10_4_6_3_1
-					MIX_11_4_5_3_1
-					}
-					else
-					{
-					MIX_10_4_7_3_2_3_3
-					MIX_11_4_7_5_5_2_1
-					}
-					break;
-				case 73:
-				case 77:
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_00_4_1_3_1
-					MIX_10_4_6_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_5_2_1
-					MIX_10_4_7_3_2_3_3
-					}
-					MIX_01_4_1_5_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 42:
-				case 170:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4_0_3_1
-					MIX_10_4_7_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_10_4_3_7_5_2_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 14:
-				case 142:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4_0_3_1
-					MIX_01_4_5_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_01_4_1_5_5_2_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 67:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 70:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_5_3_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 28:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 152:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 194:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_5_3_1
-					break;
-				case 98:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 56:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 25:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 26:
-				case 31:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 82:
-				case 214:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 88:
-				case 248:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 74:
-				case 107:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 27:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 86:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_3_1
-					break;
-				case 216:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 106:
-					MIX_00_4_0_3_1
-					MIX_01_4_2_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 30:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 210:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_3_1
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 120:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_3_1
-					break;
-				case 75:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 29:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 198:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_5_3_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_5_3_1
-					break;
-				case 184:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 99:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 57:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 71:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 156:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 226:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 60:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 195:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_5_3_1
-					break;
-				case 102:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_5_3_1
-					MIX_10_4_3_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 153:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 58:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 83:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 92:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 202:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 78:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 154:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 114:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 89:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 90:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 55:
-				case 23:
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_00_4_3_3_1
-					MIX_01_4
-					}
-					else
-					{
-					MIX_00_4_1_3_5_2_1
-					MIX_01_4_1_5_2_3_3
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 182:
-				case 150:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_01_4
-					MIX_11_4_7_3_1
-					}
-					else
-					{
-					MIX_01_4_1_5_2_3_3
-					MIX_11_4_5_7_5_2_1
-					}
-					MIX_10_4_7_3_2_1_1
-					break;
-				case 213:
-				case 212:
-					MIX_00_4_3_1_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_01_4_1_3_1
-					MIX_11_4
-					}
-					else
-					{
-					MIX_01_4_5_1_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					MIX_10_4_6_3_2_1_1
-					break;
-				case 241:
-				case 240:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_10_4_3_3_1
-					MIX_11_4
-					}
-					else
-					{
-					MIX_10_4_7_3_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					break;
-				case 236:
-				case 232:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_10_4
-					MIX_11_4_5_3_1
-					}
-					else
-					{
-					MIX_10_4_7_3_2_3_3
-					MIX_11_4_7_5_5_2_1
-					}
-					break;
-				case 109:
-				case 105:
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_00_4_1_3_1
-					MIX_10_4
-					}
-					else
-					{
-					MIX_00_4_3_1_5_2_1
-					MIX_10_4_7_3_2_3_3
-					}
-					MIX_01_4_1_5_2_1_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 171:
-				case 43:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4
-					MIX_10_4_7_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_10_4_3_7_5_2_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 143:
-				case 15:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4
-					MIX_01_4_5_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_01_4_1_5_5_2_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 124:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_3_1
-					break;
-				case 203:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_6_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 62:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 211:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_3_1
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 118:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_3_3_1
-					MIX_11_4_8_3_1
-					break;
-				case 217:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_6_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 110:
-					MIX_00_4_0_3_1
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 155:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 188:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 185:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 61:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 157:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 103:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_3_3_1
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 227:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 230:
-					MIX_00_4_0_3_2_1_1
-					MIX_01_4_5_3_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 199:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_6_3_2_1_1
-					MIX_11_4_5_3_1
-					break;
-				case 220:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 158:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 234:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 242:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 59:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 121:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 87:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 79:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 122:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 94:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 218:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 91:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 229:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 167:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 173:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_5_2_1_1
-					MIX_10_4_7_3_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 181:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 186:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 115:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 93:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 206:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 205:
-				case 201:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4_6_3_1
-					}
-					else
-					{
-						MIX_10_4_7_3_6_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 174:
-				case 46:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4_0_3_1
-					}
-					else
-					{
-						MIX_00_4_3_1_6_1_1
-					}
-					MIX_01_4_5_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 179:
-				case 147:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4_2_3_1
-					}
-					else
-					{
-						MIX_01_4_1_5_6_1_1
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 117:
-				case 116:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4_8_3_1
-					}
-					else
-					{
-						MIX_11_4_5_7_6_1_1
-					}
-					break;
-				case 189:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 231:
-					MIX_00_4_3_3_1
-					MIX_01_4_5_3_1
-					MIX_10_4_3_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 126:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_3_1
-					break;
-				case 219:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_3_1
-					MIX_10_4_6_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 125:
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_00_4_1_3_1
-					MIX_10_4
-					}
-					else
-					{
-					MIX_00_4_3_1_5_2_1
-					MIX_10_4_7_3_2_3_3
-					}
-					MIX_01_4_1_3_1
-					MIX_11_4_8_3_1
-					break;
-				case 221:
-					MIX_00_4_1_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_01_4_1_3_1
-					MIX_11_4
-					}
-					else
-					{
-					MIX_01_4_5_1_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					MIX_10_4_6_3_1
-					break;
-				case 207:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4
-					MIX_01_4_5_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_01_4_1_5_5_2_1
-					}
-					MIX_10_4_6_3_1
-					MIX_11_4_5_3_1
-					break;
-				case 238:
-					MIX_00_4_0_3_1
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-					MIX_10_4
-					MIX_11_4_5_3_1
-					}
-					else
-					{
-					MIX_10_4_7_3_2_3_3
-					MIX_11_4_7_5_5_2_1
-					}
-					break;
-				case 190:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_01_4
-					MIX_11_4_7_3_1
-					}
-					else
-					{
-					MIX_01_4_1_5_2_3_3
-					MIX_11_4_5_7_5_2_1
-					}
-					MIX_10_4_7_3_1
-					break;
-				case 187:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-					MIX_00_4
-					MIX_10_4_7_3_1
-					}
-					else
-					{
-					MIX_00_4_3_1_2_3_3
-					MIX_10_4_3_7_5_2_1
-					}
-					MIX_01_4_2_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 243:
-					MIX_00_4_3_3_1
-					MIX_01_4_2_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-					MIX_10_4_3_3_1
-					MIX_11_4
-					}
-					else
-					{
-					MIX_10_4_7_3_5_2_1
-					MIX_11_4_5_7_2_3_3
-					}
-					break;
-				case 119:
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-					MIX_00_4_3_3_1
-					MIX_01_4
-					}
-					else
-					{
-					MIX_00_4_1_3_5_2_1
-					MIX_01_4_1_5_2_3_3
-					}
-					MIX_10_4_3_3_1
-					MIX_11_4_8_3_1
-					break;
-				case 237:
-				case 233:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 175:
-				case 47:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					MIX_01_4_5_3_1
-					MIX_10_4_7_3_1
-					MIX_11_4_5_7_2_1_1
-					break;
-				case 183:
-				case 151:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_7_3_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 245:
-				case 244:
-					MIX_00_4_3_1_2_1_1
-					MIX_01_4_1_3_1
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 250:
-					MIX_00_4_0_3_1
-					MIX_01_4_2_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 123:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_3_1
-					break;
-				case 95:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_3_1
-					MIX_11_4_8_3_1
-					break;
-				case 222:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_6_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 252:
-					MIX_00_4_0_1_2_1_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 249:
-					MIX_00_4_1_3_1
-					MIX_01_4_2_1_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 235:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_5_2_1_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 111:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_5_2_1_1
-					break;
-				case 63:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_8_7_2_1_1
-					break;
-				case 159:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_6_7_2_1_1
-					MIX_11_4_7_3_1
-					break;
-				case 215:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_6_3_2_1_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 246:
-					MIX_00_4_0_3_2_1_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 254:
-					MIX_00_4_0_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 253:
-					MIX_00_4_1_3_1
-					MIX_01_4_1_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 251:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					MIX_01_4_2_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 239:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					MIX_01_4_5_3_1
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_e_1_1
-					}
-					MIX_11_4_5_3_1
-					break;
-				case 127:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_2_1_1
-					}
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-					{
-						MIX_10_4
-					}
-					else
-					{
-						MIX_10_4_7_3_2_1_1
-					}
-					MIX_11_4_8_3_1
-					break;
-				case 191:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_e_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_7_3_1
-					MIX_11_4_7_3_1
-					break;
-				case 223:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-					{
-						MIX_00_4
-					}
-					else
-					{
-						MIX_00_4_3_1_2_1_1
-					}
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_6_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_2_1_1
-					}
-					break;
-				case 247:
-					MIX_00_4_3_3_1
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-					{
-						MIX_01_4
-					}
-					else
-					{
-						MIX_01_4_1_5_e_1_1
-					}
-					MIX_10_4_3_3_1
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-					{
-						MIX_11_4
-					}
-					else
-					{
-						MIX_11_4_5_7_e_1_1
-					}
-					break;
-				case 255:
-					if (isDifferent(w[3], w[1], trY, trU, trV, trA))
-						MIX_00_4
-					else
-						MIX_00_4_3_1_e_1_1
-
-					if (isDifferent(w[1], w[5], trY, trU, trV, trA))
-						MIX_01_4
-					else
-						MIX_01_4_1_5_e_1_1
-
-					if (isDifferent(w[7], w[3], trY, trU, trV, trA))
-						MIX_10_4
-					else
-						MIX_10_4_7_3_e_1_1
-
-					if (isDifferent(w[5], w[7], trY, trU, trV, trA))
-						MIX_11_4
-					else
-						MIX_11_4_5_7_e_1_1
-					break;
-			}
-			image++;
-			output += 2;
-		}
-		output += lineSize;
-	}
-
-	return output;
-}
+#undef USE
+#undef TEST
 
+// The blend kernel for each pattern and outcome of its tests.
+static const std::array<HqxKernel, 256 * 16> &kernels =
+	HqxKernels<2, rules>::table;
 
 // Publicly visible wrapper functions. 
 //
 // The constant values supplied for the trailing arguments were provided
-// as default values in the original impl.
+// as default values in the original impl. The image is converted to YUV,
+// and its pattern plane is computed, once up front (or its palette is
+// found); bands of rows are then scaled on the thread pool.
+
+template <char Mode>
+static void hq2x( uint32_t *img, int w, int h, uint32_t *out ) {
+  hqxScale<2, Mode>( img, w, h, [=]( const auto &src, int j0, int j1,
+					HqxCache<2> *cache ) {
+      hqxRows<2, HqxKernels<2, rules>>( rules, src, w, h,
+					   out + (size_t) j0*w*4, j0, j1, cache );
+    } );
+}
 
 void hq2xA( uint32_t *img, int w, int h, uint32_t *out ) {
-  hq2x_resize( 'A', img, w, h, out, 0x30, 0x07, 0x06, 0x50, false, false );
+  hq2x<'A'>( img, w, h, out );
 }
 
 void hq2xB( uint32_t *img, int w, int h, uint32_t *out ) {
-  hq2x_resize( 'B', img, w, h, out, 0x30, 0x07, 0x06, 0x50, false, false );
+  hq2x<'B'>( img, w, h, out );
 }
@@ -17,13 +17,20 @@
  * and modified by Philipp K. Janert, September 2022
  */
 
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
-#include "hqx.h"
+#include <functional>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-static const uint32_t AMASK = 0xFF000000;
-static const uint32_t YMASK = 0x00FF0000;
-static const uint32_t UMASK = 0x0000FF00;
-static const uint32_t VMASK = 0x000000FF;
+#include "cpu.h"
+#include "hqx.h"
+#include "hqx1.h"
+#include "threads.h"
 
 // PKJ:
 // All hq-related fcts used to be member fcts of otherwise empty classes.
@@ -44,53 +51,701 @@ uint32_t ARGBtoAYUV( uint32_t value )
     return (A << 24) + (Y << 16) + (U << 8) + V;
 }
 
-/*
- * Use this function for sharper images (good for cartoon style, used by DOSBOX)
- */
-bool isDifferentA(
-	uint32_t color1,
-	uint32_t color2,
-	uint32_t trY,
-	uint32_t trU,
-	uint32_t trV,
-	uint32_t trA )
+// Conversion of whole rows of pixels to AYUV. The SIMD versions do the
+// same double precision arithmetic as ARGBtoAYUV, in the same order (and
+// without fused multiply-add), and truncate toward zero like the casts in
+// ARGBtoAYUV, so that the results agree exactly.
+
+static void rowToAYUVScalar( const uint32_t *src, uint32_t *dst, size_t count )
 {
-	color1 = ARGBtoAYUV(color1);
-	color2 = ARGBtoAYUV(color2);
+	for (size_t j = 0; j < count; j++)
+		dst[j] = ARGBtoAYUV(src[j]);
+}
 
-	uint32_t value;
+#if defined(__x86_64__) || defined(__i386__)
 
-	value = abs(int(color1 & YMASK) - int(color2 & YMASK));
-	if (value > trY) return true;
+// Converts two pixels, given as 32 bit channel values in the low half of
+// r, g, b, to Y, U - 128, V - 128 in the low half of y, u, v.
+__attribute__((target("sse2")))
+static inline void yuvSSE2( __m128i r, __m128i g, __m128i b,
+			    __m128i &y, __m128i &u, __m128i &v )
+{
+	__m128d R = _mm_cvtepi32_pd( r );
+	__m128d G = _mm_cvtepi32_pd( g );
+	__m128d B = _mm_cvtepi32_pd( b );
+
+	__m128d Y = _mm_add_pd( _mm_add_pd( _mm_mul_pd( _mm_set1_pd( 0.299 ), R ),
+					    _mm_mul_pd( _mm_set1_pd( 0.587 ), G ) ),
+				_mm_mul_pd( _mm_set1_pd( 0.114 ), B ) );
+	__m128d U = _mm_add_pd( _mm_sub_pd( _mm_mul_pd( _mm_set1_pd( -0.169 ), R ),
+					    _mm_mul_pd( _mm_set1_pd( 0.331 ), G ) ),
+				_mm_mul_pd( _mm_set1_pd( 0.5 ), B ) );
+	__m128d V = _mm_sub_pd( _mm_sub_pd( _mm_mul_pd( _mm_set1_pd( 0.5 ), R ),
+					    _mm_mul_pd( _mm_set1_pd( 0.419 ), G ) ),
+				_mm_mul_pd( _mm_set1_pd( 0.081 ), B ) );
 
-	value = abs(int(color1 & UMASK) - int(color2 & UMASK));
-	if (value > trU) return true;
+	y = _mm_cvttpd_epi32( Y );
+	u = _mm_cvttpd_epi32( U );
+	v = _mm_cvttpd_epi32( V );
+}
+
+__attribute__((target("sse2")))
+static void rowToAYUVSSE2( const uint32_t *src, uint32_t *dst, size_t count )
+{
+	const __m128i mask = _mm_set1_epi32( 0xFF );
+	const __m128i alpha = _mm_set1_epi32( 0xFF000000 );
+	const __m128i bias = _mm_set1_epi32( 128 );
+	size_t j = 0;
 
-	value = abs(int(color1 & VMASK) - int(color2 & VMASK));
-	if (value > trV) return true;
+	// 4 pixels per step, in two halves of two
+	for (; j + 4 <= count; j += 4)
+	{
+		__m128i p = _mm_loadu_si128( (const __m128i*) (src + j) );
+		__m128i r = _mm_and_si128( _mm_srli_epi32( p, 16 ), mask );
+		__m128i g = _mm_and_si128( _mm_srli_epi32( p, 8 ), mask );
+		__m128i b = _mm_and_si128( p, mask );
 
-	value = abs(int(color1 & AMASK) - int(color2 & AMASK));
-	if (value > trA) return true;
+		__m128i y0, u0, v0, y1, u1, v1;
+		yuvSSE2( r, g, b, y0, u0, v0 );
+		yuvSSE2( _mm_shuffle_epi32( r, 0xEE ), _mm_shuffle_epi32( g, 0xEE ),
+			 _mm_shuffle_epi32( b, 0xEE ), y1, u1, v1 );
 
-	return false;
+		__m128i y = _mm_unpacklo_epi64( y0, y1 );
+		__m128i u = _mm_add_epi32( _mm_unpacklo_epi64( u0, u1 ), bias );
+		__m128i v = _mm_add_epi32( _mm_unpacklo_epi64( v0, v1 ), bias );
+
+		__m128i q = _mm_add_epi32( _mm_and_si128( p, alpha ),
+					   _mm_slli_epi32( y, 16 ) );
+		q = _mm_add_epi32( q, _mm_slli_epi32( u, 8 ) );
+		q = _mm_add_epi32( q, v );
+		_mm_storeu_si128( (__m128i*) (dst + j), q );
+	}
+	rowToAYUVScalar( src + j, dst + j, count - j );
 }
 
-/*
- * Use this function for smoothed images (good for complex graphics)
- */
-bool isDifferentB(
-	uint32_t color1,
-	uint32_t color2,
+__attribute__((target("avx2")))
+static void rowToAYUVAVX2( const uint32_t *src, uint32_t *dst, size_t count )
+{
+	const __m128i mask = _mm_set1_epi32( 0xFF );
+	const __m128i alpha = _mm_set1_epi32( 0xFF000000 );
+	const __m128i bias = _mm_set1_epi32( 128 );
+	size_t j = 0;
+
+	// 4 pixels per step, one per double precision lane
+	for (; j + 4 <= count; j += 4)
+	{
+		__m128i p = _mm_loadu_si128( (const __m128i*) (src + j) );
+		__m256d R = _mm256_cvtepi32_pd( _mm_and_si128( _mm_srli_epi32( p, 16 ), mask ) );
+		__m256d G = _mm256_cvtepi32_pd( _mm_and_si128( _mm_srli_epi32( p, 8 ), mask ) );
+		__m256d B = _mm256_cvtepi32_pd( _mm_and_si128( p, mask ) );
+
+		__m256d Y = _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( _mm256_set1_pd( 0.299 ), R ),
+							  _mm256_mul_pd( _mm256_set1_pd( 0.587 ), G ) ),
+					   _mm256_mul_pd( _mm256_set1_pd( 0.114 ), B ) );
+		__m256d U = _mm256_add_pd( _mm256_sub_pd( _mm256_mul_pd( _mm256_set1_pd( -0.169 ), R ),
+							  _mm256_mul_pd( _mm256_set1_pd( 0.331 ), G ) ),
+					   _mm256_mul_pd( _mm256_set1_pd( 0.5 ), B ) );
+		__m256d V = _mm256_sub_pd( _mm256_sub_pd( _mm256_mul_pd( _mm256_set1_pd( 0.5 ), R ),
+							  _mm256_mul_pd( _mm256_set1_pd( 0.419 ), G ) ),
+					   _mm256_mul_pd( _mm256_set1_pd( 0.081 ), B ) );
+
+		__m128i y = _mm256_cvttpd_epi32( Y );
+		__m128i u = _mm_add_epi32( _mm256_cvttpd_epi32( U ), bias );
+		__m128i v = _mm_add_epi32( _mm256_cvttpd_epi32( V ), bias );
+
+		__m128i q = _mm_add_epi32( _mm_and_si128( p, alpha ),
+					   _mm_slli_epi32( y, 16 ) );
+		q = _mm_add_epi32( q, _mm_slli_epi32( u, 8 ) );
+		q = _mm_add_epi32( q, v );
+		_mm_storeu_si128( (__m128i*) (dst + j), q );
+	}
+	rowToAYUVScalar( src + j, dst + j, count - j );
+}
+
+#endif
+
+typedef void (*RowToAYUVFn)( const uint32_t *src, uint32_t *dst, size_t count );
+
+// Picks the fastest converter the processor supports.
+static RowToAYUVFn selectRowToAYUV() {
+#if defined(__x86_64__) || defined(__i386__)
+	if (cpuLevel() >= CPU_AVX2) return &rowToAYUVAVX2;
+	if (cpuLevel() >= CPU_SSSE3) return &rowToAYUVSSE2;
+#endif
+	return &rowToAYUVScalar;
+}
+
+static const RowToAYUVFn rowToAYUV = selectRowToAYUV();
+
+// Converts a w x h image to AYUV, in bands of rows on the thread pool.
+void imageToAYUV( const uint32_t *image, int w, int h, uint32_t *yuv )
+{
+	parallelFor( 0, h, [=]( int j0, int j1 ) {
+		rowToAYUV( image + (size_t) j0*w, yuv + (size_t) j0*w,
+			   (size_t) (j1 - j0)*w );
+	} );
+}
+
+// The hqx pattern of a pixel has one bit for each of its 8 neighbours
+// (w0, w1, w2, w3, w5, w6, w7, w8, from bit 0 up), which is set if the
+// neighbour's color is different from the pixel's color. The pattern
+// plane holds the patterns of all pixels of an image.
+//
+// Inside of the image, patterns are assembled from edge difference bits:
+// each pixel holds the edges to its right (H), lower (V) and lower right
+// (D1) neighbour, and the edge from its right to its lower neighbour (D2).
+// Each edge is tested once, instead of once from either end.
+
+#define EDGE_H    0x01
+#define EDGE_V    0x02
+#define EDGE_D1   0x04
+#define EDGE_D2   0x08
+
+// Thresholds of a difference test: shifted into place for isDifferent,
+// and one per byte (V, U, Y, A from the low byte up) for the SIMD tests.
+struct EdgeTest {
+	bool (*isDifferent)( uint32_t color1, uint32_t color2,
+			     uint32_t trY, uint32_t trU,
+			     uint32_t trV, uint32_t trA );
+	uint32_t trY, trU, trV, trA;
+	uint32_t bytes;
+};
+
+// The edges of a row, from column col on. Equal colors are never
+// different, as in the pattern loop of the original implementation.
+static void edgeRowScalar( const uint32_t *image, const uint32_t *yuv,
+			   int w, int h, int row, int col,
+			   const EdgeTest &t, uint8_t *edges )
+{
+	size_t p = (size_t) row * w + col;
+	bool below = row < h - 1;
+
+	for (; col < w; col++, p++)
+	{
+		bool right = col < w - 1;
+		uint8_t e = 0;
+
+		if (right && image[p] != image[p + 1] &&
+		    t.isDifferent(yuv[p], yuv[p + 1], t.trY, t.trU, t.trV, t.trA))
+			e |= EDGE_H;
+		if (below && image[p] != image[p + w] &&
+		    t.isDifferent(yuv[p], yuv[p + w], t.trY, t.trU, t.trV, t.trA))
+			e |= EDGE_V;
+		if (right && below && image[p] != image[p + w + 1] &&
+		    t.isDifferent(yuv[p], yuv[p + w + 1], t.trY, t.trU, t.trV, t.trA))
+			e |= EDGE_D1;
+		if (right && below && image[p + 1] != image[p + w] &&
+		    t.isDifferent(yuv[p + 1], yuv[p + w], t.trY, t.trU, t.trV, t.trA))
+			e |= EDGE_D2;
+
+		edges[p] = e;
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The SIMD versions test 8 (AVX2) or 16 (AVX-512) pixels at once, one per
+// 32 bit lane, on the bytes of the AYUV values. For Y, U and V, that is
+// the absolute difference, as in isDifferent. For A, isDifferent takes the
+// difference of the alpha bytes in the top of an int, where it wraps
+// around: the distance is the smaller of the two byte differences modulo
+// 256. Equal colors have equal AYUV values, so they are never different,
+// and the color test of the scalar version can be skipped. The last row
+// and the last few columns are left to the scalar version.
+
+__attribute__((target("avx2")))
+static inline __m256i differentAVX2( __m256i a, __m256i b, __m256i thr )
+{
+	const __m256i amask = _mm256_set1_epi32( 0xFF000000 );
+	__m256i d = _mm256_or_si256( _mm256_subs_epu8( a, b ),
+				     _mm256_subs_epu8( b, a ) );
+	__m256i c = _mm256_min_epu8( _mm256_sub_epi8( a, b ),
+				     _mm256_sub_epi8( b, a ) );
+	d = _mm256_blendv_epi8( d, c, amask );
+
+	// all ones where no channel exceeds its threshold, then inverted
+	__m256i same = _mm256_cmpeq_epi32( _mm256_subs_epu8( d, thr ),
+					   _mm256_setzero_si256() );
+	return _mm256_xor_si256( same, _mm256_set1_epi32( -1 ) );
+}
+
+__attribute__((target("avx2")))
+static void edgeRowAVX2( const uint32_t *image, const uint32_t *yuv,
+			 int w, int h, int row, int col,
+			 const EdgeTest &t, uint8_t *edges )
+{
+	if (row < h - 1)
+	{
+		const __m256i thr = _mm256_set1_epi32( t.bytes );
+		const uint32_t *p = yuv + (size_t) row * w;
+		uint8_t *e = edges + (size_t) row * w;
+
+		// the loads reach one pixel to the right of the 8 being tested
+		for (; col + 9 <= w; col += 8)
+		{
+			__m256i c  = _mm256_loadu_si256( (const __m256i*) (p + col) );
+			__m256i r  = _mm256_loadu_si256( (const __m256i*) (p + col + 1) );
+			__m256i d  = _mm256_loadu_si256( (const __m256i*) (p + col + w) );
+			__m256i dr = _mm256_loadu_si256( (const __m256i*) (p + col + w + 1) );
+
+			__m256i v = _mm256_and_si256( differentAVX2( c, r, thr ),
+						      _mm256_set1_epi32( EDGE_H ) );
+			v = _mm256_or_si256( v, _mm256_and_si256( differentAVX2( c, d, thr ),
+								  _mm256_set1_epi32( EDGE_V ) ) );
+			v = _mm256_or_si256( v, _mm256_and_si256( differentAVX2( c, dr, thr ),
+								  _mm256_set1_epi32( EDGE_D1 ) ) );
+			v = _mm256_or_si256( v, _mm256_and_si256( differentAVX2( r, d, thr ),
+								  _mm256_set1_epi32( EDGE_D2 ) ) );
+
+			__m128i x = _mm_packus_epi32( _mm256_castsi256_si128( v ),
+						      _mm256_extracti128_si256( v, 1 ) );
+			x = _mm_packus_epi16( x, x );
+			_mm_storel_epi64( (__m128i*) (e + col), x );
+		}
+	}
+	edgeRowScalar( image, yuv, w, h, row, col, t, edges );
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __mmask16 differentAVX512( __m512i a, __m512i b, __m512i thr )
+{
+	__m512i d = _mm512_or_si512( _mm512_subs_epu8( a, b ),
+				     _mm512_subs_epu8( b, a ) );
+	__m512i c = _mm512_min_epu8( _mm512_sub_epi8( a, b ),
+				     _mm512_sub_epi8( b, a ) );
+	d = _mm512_mask_blend_epi8( 0x8888888888888888ULL, d, c );
+
+	__m512i over = _mm512_subs_epu8( d, thr );
+	return _mm512_test_epi32_mask( over, over );
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void edgeRowAVX512( const uint32_t *image, const uint32_t *yuv,
+			   int w, int h, int row, int col,
+			   const EdgeTest &t, uint8_t *edges )
+{
+	if (row < h - 1)
+	{
+		const __m512i thr = _mm512_set1_epi32( t.bytes );
+		const uint32_t *p = yuv + (size_t) row * w;
+		uint8_t *e = edges + (size_t) row * w;
+
+		// the loads reach one pixel to the right of the 16 being tested
+		for (; col + 17 <= w; col += 16)
+		{
+			__m512i c  = _mm512_loadu_si512( p + col );
+			__m512i r  = _mm512_loadu_si512( p + col + 1 );
+			__m512i d  = _mm512_loadu_si512( p + col + w );
+			__m512i dr = _mm512_loadu_si512( p + col + w + 1 );
+
+			__m512i v = _mm512_maskz_mov_epi32( differentAVX512( c, r, thr ),
+							    _mm512_set1_epi32( EDGE_H ) );
+			v = _mm512_mask_or_epi32( v, differentAVX512( c, d, thr ), v,
+						  _mm512_set1_epi32( EDGE_V ) );
+			v = _mm512_mask_or_epi32( v, differentAVX512( c, dr, thr ), v,
+						  _mm512_set1_epi32( EDGE_D1 ) );
+			v = _mm512_mask_or_epi32( v, differentAVX512( r, d, thr ), v,
+						  _mm512_set1_epi32( EDGE_D2 ) );
+
+			_mm_storeu_si128( (__m128i*) (e + col), _mm512_cvtepi32_epi8( v ) );
+		}
+	}
+	edgeRowScalar( image, yuv, w, h, row, col, t, edges );
+}
+
+#endif
+
+typedef void (*EdgeRowFn)( const uint32_t *image, const uint32_t *yuv,
+			   int w, int h, int row, int col,
+			   const EdgeTest &t, uint8_t *edges );
+
+// Picks the fastest edge test the processor supports.
+static EdgeRowFn selectEdgeRow() {
+#if defined(__x86_64__) || defined(__i386__)
+	if (cpuLevel() >= CPU_AVX512) return &edgeRowAVX512;
+	if (cpuLevel() >= CPU_AVX2) return &edgeRowAVX2;
+#endif
+	return &edgeRowScalar;
+}
+
+static const EdgeRowFn edgeRow = selectEdgeRow();
+
+// Assembles the pattern of an interior pixel from the edge bits, given
+// the pixel's entry and the row stride.
+static inline uint8_t edgePattern( const uint8_t *e, ptrdiff_t stride )
+{
+	const uint8_t *up = e - stride;
+
+	return ((up[-1] & EDGE_D1) >> 2) |	// w0
+		(up[0] & EDGE_V) |		// w1
+		((up[0] & EDGE_D2) >> 1) |	// w2
+		((e[-1] & EDGE_H) << 3) |	// w3
+		((e[0] & EDGE_H) << 4) |	// w5
+		((e[-1] & EDGE_D2) << 2) |	// w6
+		((e[0] & EDGE_V) << 5) |	// w7
+		((e[0] & EDGE_D1) << 5);	// w8
+}
+
+// The pattern of a pixel on the border of the image, from the same 3x3
+// window as in the original implementation: neighbours outside of the
+// image wrap around, or are replaced by the window's center column or row.
+static uint8_t windowPattern( const uint32_t *image, const uint32_t *yuv,
+			      int w, int h, int row, int col,
+			      bool wrapX, bool wrapY, const EdgeTest &t )
+{
+	ptrdiff_t rows[3], cols[3];
+
+	rows[0] = row > 0 ? -(ptrdiff_t) w : wrapY ? (ptrdiff_t) w * (h - 1) : 0;
+	rows[1] = 0;
+	rows[2] = row < h - 1 ? (ptrdiff_t) w : wrapY ? -(ptrdiff_t) w * (h - 1) : 0;
+	cols[0] = col > 0 ? -1 : wrapX ? w - 1 : 0;
+	cols[1] = 0;
+	cols[2] = col < w - 1 ? 1 : wrapX ? -(w - 1) : 0;
+
+	size_t p = (size_t) row * w + col;
+	uint8_t pattern = 0;
+
+	for (int k = 0, flag = 1; k < 9; k++)
+	{
+		if (k == 4) continue;
+
+		size_t q = p + rows[k / 3] + cols[k % 3];
+		if (image[q] != image[p] &&
+		    t.isDifferent(yuv[p], yuv[q], t.trY, t.trU, t.trV, t.trA))
+			pattern |= flag;
+		flag <<= 1;
+	}
+	return pattern;
+}
+
+// Computes the pattern plane of a w x h image, given in ARGB and in AYUV.
+// The thresholds are per channel, before they are shifted into place for
+// isDifferentA and isDifferentB. Both the edge tests and the patterns are
+// computed in bands of rows on the thread pool.
+void patternPlane(
+	char mode,
+	const uint32_t *image,
+	const uint32_t *yuv,
+	int w,
+	int h,
 	uint32_t trY,
 	uint32_t trU,
 	uint32_t trV,
-	uint32_t trA )
+	uint32_t trA,
+	bool wrapX,
+	bool wrapY,
+	uint8_t *patterns )
+{
+	EdgeTest t;
+	t.isDifferent = mode == 'B' ? &isDifferentB : &isDifferentA;
+	t.trY = trY << 16;
+	t.trU = trU << 8;
+	t.trV = trV;
+	t.trA = trA << 24;
+	t.bytes = (trY < 255 ? trY : 255) << 16 | (trU < 255 ? trU : 255) << 8 |
+		(trV < 255 ? trV : 255) | (trA < 255 ? trA : 255) << 24;
+
+	std::vector<uint8_t> edges( (size_t) w * h );
+	uint8_t *e = edges.data();
+
+	parallelFor( 0, h, [=, &t]( int j0, int j1 ) {
+		for (int row = j0; row < j1; row++)
+			edgeRow( image, yuv, w, h, row, 0, t, e );
+	} );
+
+	parallelFor( 0, h, [=, &t]( int j0, int j1 ) {
+		for (int row = j0; row < j1; row++)
+		{
+			size_t p = (size_t) row * w;
+
+			if (row == 0 || row == h - 1)
+			{
+				for (int col = 0; col < w; col++)
+					patterns[p + col] = windowPattern( image, yuv, w, h, row, col,
+									   wrapX, wrapY, t );
+				continue;
+			}
+
+			patterns[p] = windowPattern( image, yuv, w, h, row, 0,
+						     wrapX, wrapY, t );
+			for (int col = 1; col < w - 1; col++)
+				patterns[p + col] = edgePattern( e + p + col, w );
+			if (w > 1)
+				patterns[p + w - 1] = windowPattern( image, yuv, w, h, row, w - 1,
+								     wrapX, wrapY, t );
+		}
+	} );
+}
+
+// Finds the palette of an image in one pass, with a small open-addressing
+// table from colors to indices. Runs of one color skip the table, and the
+// scan stops at the 257th color.
+int findPalette( const uint32_t *image, int w, int h,
+		 uint32_t *palette, uint8_t *indices )
+{
+	const size_t size = (size_t) w * h;
+	if (size == 0)
+		return 0;
+
+	const int slots = 1024;
+	uint32_t keys[slots];
+	int16_t values[slots];
+	for (int k = 0; k < slots; k++)
+		values[k] = -1;
+
+	int n = 0;
+	uint32_t last = ~image[0];
+	uint8_t index = 0;
+	for (size_t p = 0; p < size; p++)
+	{
+		uint32_t color = image[p];
+		if (color != last)
+		{
+			uint32_t k = (color * 0x9E3779B1u) >> 22;
+			while (values[k] >= 0 && keys[k] != color)
+				k = (k + 1) & (slots - 1);
+			if (values[k] < 0)
+			{
+				if (n == 256)
+					return 0;
+				keys[k] = color;
+				values[k] = n;
+				palette[n++] = color;
+			}
+			last = color;
+			index = values[k];
+		}
+		indices[p] = index;
+	}
+	return n;
+}
+
+void paletteDifferences( char mode, const uint32_t *palette, int n,
+			 uint32_t trY, uint32_t trU, uint32_t trV, uint32_t trA,
+			 uint32_t *differences )
+{
+	bool (*isDifferent)( uint32_t, uint32_t, uint32_t, uint32_t,
+			     uint32_t, uint32_t ) =
+		mode == 'B' ? &isDifferentB : &isDifferentA;
+
+	uint32_t yuv[256];
+	for (int a = 0; a < n; a++)
+		yuv[a] = ARGBtoAYUV( palette[a] );
+
+	for (int k = 0; k < 256 * 8; k++)
+		differences[k] = 0;
+
+	// The colors of a palette are distinct, so only the diagonal is
+	// never different.
+	for (int a = 0; a < n; a++)
+		for (int b = 0; b < n; b++)
+			if (a != b && isDifferent( yuv[a], yuv[b], trY << 16, trU << 8,
+						   trV, trA << 24 ))
+				differences[a * 8 + (b >> 5)] |= 1u << (b & 31);
+}
+
+// Whether the palette colors at indices a and b are different.
+static inline bool paletteDifferent( const uint32_t *differences,
+				     uint8_t a, uint8_t b )
+{
+	return differences[a * 8 + (b >> 5)] >> (b & 31) & 1;
+}
+
+// The edges of a row of a palette image, as edgeRowScalar finds them, from
+// the difference bits of the indices.
+static void edgeRowPalette( const uint8_t *indices, const uint32_t *differences,
+			    int w, int h, int row, uint8_t *edges )
+{
+	size_t p = (size_t) row * w;
+	bool below = row < h - 1;
+
+	for (int col = 0; col < w; col++, p++)
+	{
+		bool right = col < w - 1;
+		uint8_t e = 0;
+
+		if (right && paletteDifferent( differences, indices[p], indices[p + 1] ))
+			e |= EDGE_H;
+		if (below && paletteDifferent( differences, indices[p], indices[p + w] ))
+			e |= EDGE_V;
+		if (right && below &&
+		    paletteDifferent( differences, indices[p], indices[p + w + 1] ))
+			e |= EDGE_D1;
+		if (right && below &&
+		    paletteDifferent( differences, indices[p + 1], indices[p + w] ))
+			e |= EDGE_D2;
+
+		edges[p] = e;
+	}
+}
+
+// The pattern of a pixel on the border of a palette image, as
+// windowPattern finds it without wrapping.
+static uint8_t windowPatternPalette( const uint8_t *indices,
+				     const uint32_t *differences,
+				     int w, int h, int row, int col )
+{
+	ptrdiff_t rows[3] = { row > 0 ? -(ptrdiff_t) w : 0, 0,
+			      row < h - 1 ? (ptrdiff_t) w : 0 };
+	ptrdiff_t cols[3] = { col > 0 ? -1 : 0, 0, col < w - 1 ? 1 : 0 };
+
+	size_t p = (size_t) row * w + col;
+	uint8_t pattern = 0;
+
+	for (int k = 0, flag = 1; k < 9; k++)
+	{
+		if (k == 4) continue;
+
+		if (paletteDifferent( differences, indices[p],
+				      indices[p + rows[k / 3] + cols[k % 3]] ))
+			pattern |= flag;
+		flag <<= 1;
+	}
+	return pattern;
+}
+
+// Computes the pattern plane of a palette image, as patternPlane does for
+// its ARGB and AYUV planes (without wrapping).
+void palettePatterns( const uint8_t *indices, const uint32_t *differences,
+		      int w, int h, uint8_t *patterns )
 {
-	uint32_t yuv1 = ARGBtoAYUV(color1);
-	uint32_t yuv2 = ARGBtoAYUV(color2);
+	std::vector<uint8_t> edges( (size_t) w * h );
+	uint8_t *e = edges.data();
 
-	return abs(int(yuv1 & YMASK) - int(yuv2 & YMASK)) > trY ||
-		   abs(int(yuv1 & UMASK) - int(yuv2 & UMASK)) > trU ||
-		   abs(int(yuv1 & VMASK) - int(yuv2 & VMASK)) > trV ||
-		   abs(int(yuv1 & AMASK) - int(yuv2 & AMASK)) > trA;
+	parallelFor( 0, h, [=]( int j0, int j1 ) {
+		for (int row = j0; row < j1; row++)
+			edgeRowPalette( indices, differences, w, h, row, e );
+	} );
+
+	parallelFor( 0, h, [=]( int j0, int j1 ) {
+		for (int row = j0; row < j1; row++)
+		{
+			size_t p = (size_t) row * w;
+
+			if (row == 0 || row == h - 1)
+			{
+				for (int col = 0; col < w; col++)
+					patterns[p + col] = windowPatternPalette( indices, differences,
+										  w, h, row, col );
+				continue;
+			}
+
+			patterns[p] = windowPatternPalette( indices, differences,
+							    w, h, row, 0 );
+			for (int col = 1; col < w - 1; col++)
+				patterns[p + col] = edgePattern( e + p + col, w );
+			if (w > 1)
+				patterns[p + w - 1] = windowPatternPalette( indices, differences,
+									    w, h, row, w - 1 );
+		}
+	} );
+}
+
+// The window cache is off by default. Bands add their counts to the totals
+// as they finish.
+static std::atomic<bool> cacheEnabled( false );
+static std::atomic<uint64_t> cacheLookups( 0 ), cacheHits( 0 );
+
+void setHqxCache( bool enabled )
+{
+	cacheEnabled = enabled;
+	cacheLookups = 0;
+	cacheHits = 0;
+}
+
+bool hqxCacheEnabled()
+{
+	return cacheEnabled;
+}
+
+void hqxCacheCount( uint64_t lookups, uint64_t hits )
+{
+	cacheLookups += lookups;
+	cacheHits += hits;
+}
+
+void hqxCacheStats( uint64_t &lookups, uint64_t &hits )
+{
+	lookups = cacheLookups;
+	hits = cacheHits;
+}
+
+// Bucketed scaling is off by default.
+static std::atomic<bool> bucketsEnabled( false );
+
+void setHqxBuckets( bool enabled )
+{
+	bucketsEnabled = enabled;
+}
+
+bool hqxBucketsEnabled()
+{
+	return bucketsEnabled;
+}
+
+// The counts of setHqxStats, which bands on all threads add to.
+#ifdef HQX_STATS
+static std::atomic<bool> statsEnabled( false );
+static std::atomic<uint64_t> statsPixels( 0 ), statsPatterns[256];
+static std::atomic<uint64_t> statsTests[4], statsDifferences[4];
+static std::atomic<uint64_t> statsComparisons( 0 ), statsEqual( 0 );
+
+bool hqxStatsEnabled()
+{
+	return statsEnabled;
+}
+
+void hqxStatsCount( int pattern, int needed, int tests, const uint32_t *w )
+{
+	const std::memory_order relaxed = std::memory_order_relaxed;
+
+	statsPixels.fetch_add( 1, relaxed );
+	statsPatterns[pattern].fetch_add( 1, relaxed );
+	for (int t = 0; t < 4; t++)
+	{
+		if (needed >> t & 1)
+			statsTests[t].fetch_add( 1, relaxed );
+		if (tests >> t & 1)
+			statsDifferences[t].fetch_add( 1, relaxed );
+	}
+
+	int equal = 0;
+	for (int k = 0; k < 9; k++)
+		equal += k != 4 && w[k] == w[4];
+	statsComparisons.fetch_add( 8, relaxed );
+	statsEqual.fetch_add( equal, relaxed );
+}
+#endif
+
+bool setHqxStats( bool enabled )
+{
+#ifdef HQX_STATS
+	statsPixels = 0;
+	for (int k = 0; k < 256; k++)
+		statsPatterns[k] = 0;
+	for (int t = 0; t < 4; t++)
+		statsTests[t] = statsDifferences[t] = 0;
+	statsComparisons = statsEqual = 0;
+	statsEnabled = enabled;
+	return true;
+#else
+	return !enabled;
+#endif
+}
+
+void hqxStats( HqxStats &stats )
+{
+	stats = HqxStats();
+#ifdef HQX_STATS
+	stats.pixels = statsPixels;
+	for (int k = 0; k < 256; k++)
+		stats.patterns[k] = statsPatterns[k];
+	for (int t = 0; t < 4; t++)
+	{
+		stats.tests[t] = statsTests[t];
+		stats.differences[t] = statsDifferences[t];
+	}
+	stats.comparisons = statsComparisons;
+	stats.equal = statsEqual;
+#endif
 }
@@ -26,36 +26,205 @@ SOFTWARE.
 */		  
 		  
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstdint>
+#include <new>
 #include <string>
 
 #include "bitmap.h"
 #include "scalenx.h"
 #include "xbr.h"
 #include "hqx.h"
+#include "stream.h"
+#include "threads.h"
+#include "tiled.h"
 
 using std::string;
 
 void print_usage(int err) {
-  if( err > 0) {
+  if( err == 1 ) {
     std::cerr << "Unknown algorithm" << std::endl << "" << std::endl;
   }
-  std::cerr << "Usage: pixelscaler algo infile [outfile]" << std::endl;
+  if( err == 2 ) {
+    std::cerr << "Unknown option" << std::endl << "" << std::endl;
+  }
+  std::cerr << "Usage: pixelscaler [options] algo infile [outfile]" << std::endl;
   std::cerr << "Algos: copy block2 block3 scale2x scale2xSFX scale3x scale3xSFX hq2xA hq2xB hq3xA hq3xB superXBR" << std::endl;
   std::cerr << "File format: Microsoft Bitmap BMP3 24bits per pixel"<<std::endl;
+  std::cerr << "Use - as infile or outfile for standard input or output" << std::endl;
+  std::cerr << "Options:" << std::endl;
+  std::cerr << "  --timing   report time and throughput of load, scale, save" << std::endl;
+  std::cerr << "  --stream   scale in bands of rows as the input is read, writing" << std::endl;
+  std::cerr << "             output as it completes (default if infile is -)" << std::endl;
+  std::cerr << "  --memory MB scale in tiles that fit into MB megabytes; for images" << std::endl;
+  std::cerr << "             larger than memory (needs regular files, not -)" << std::endl;
+  std::cerr << "  --threads N scale using N threads (0: one per processor)" << std::endl;
+  std::cerr << "  --cache    reuse the output of repeated 3x3 neighbourhoods in hqx," << std::endl;
+  std::cerr << "             and report the hit rate" << std::endl;
+  std::cerr << "  --buckets  in hqx, group pixels by blend kernel and blend each" << std::endl;
+  std::cerr << "             group eight pixels at a time (needs AVX2)" << std::endl;
+  std::cerr << "  --stats    report how often each hqx pattern and test occurs" << std::endl;
+  std::cerr << "             (needs a build with HQX_STATS defined)" << std::endl;
+  std::cerr << "  --xbr MODE run the superXBR passes in place (inplace, default)," << std::endl;
+  std::cerr << "             or each from the previous one's output, in parallel" << std::endl;
+  std::cerr << "             bands (buffered) or tile by tile (tiled), or as" << std::endl;
+  std::cerr << "             buffered in fixed point (fixed)" << std::endl;
+}
+
+// Name, kernel, scale factor, padding, and support (the number of input
+// rows above and below a row that affect its output; -1 for the whole
+// image) of each algorithm. That of superXBR depends on --xbr, and is
+// replaced by xbrSupport() once the options are read.
+static const Scaler scalers[] = {
+  { "copy",       copy,          1, 0,  0 },
+  { "block2",     block2,        2, 0,  0 },
+  { "block3",     block3,        3, 0,  0 },
+  { "scale2x",    scale2x,       2, 0,  1 },
+  { "scale2xPad", scale2xPad,    2, 1,  1 },
+  { "scale2xSFX", scale2xSFX,    2, 2,  2 },
+  { "scale3x",    scale3xPad,    3, 1,  1 },
+  { "scale3xSFX", scale3xSFX,    3, 2,  2 },
+  { "hq2xA",      hq2xA,         2, 0,  1 },
+  { "hq2xB",      hq2xB,         2, 0,  1 },
+  { "hq3xA",      hq3xA,         3, 0,  1 },
+  { "hq3xB",      hq3xB,         3, 0,  1 },
+  { "superXBR",   scaleSuperXBR, 2, 0, -1 },
+};
+
+// Reports the time elapsed since start, and the throughput for the given
+// number of bytes, on stderr.
+static void report( const char *stage,
+		    std::chrono::steady_clock::time_point start,
+		    double bytes ) {
+  std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+  std::cerr << stage << ": " << 1e3*sec.count() << " ms, "
+	    << bytes/sec.count()/1e6 << " MB/s" << std::endl;
+}
+
+// Reports the estimated memory traffic of superXBR, on stderr.
+static void reportTraffic() {
+  uint64_t image, tiles;
+  xbrTraffic( image, tiles );
+  std::cerr << "Traffic: " << image/1e6 << " MB in image buffers, "
+	    << tiles/1e6 << " MB in tile buffers" << std::endl;
+}
+
+// Reports the lookups and hits of the hqx window cache, on stderr.
+static void reportCache() {
+  uint64_t lookups, hits;
+  hqxCacheStats( lookups, hits );
+  std::cerr << "Cache: " << hits << " hits in " << lookups << " lookups ("
+	    << (lookups ? 100.0*hits/lookups : 0.0) << "%)" << std::endl;
+}
+
+// Reports the counts of hqx, on stderr: the tie-break tests and the
+// neighbour comparisons, then the patterns that occurred, most frequent
+// first, with their share and the running total.
+static void reportStats() {
+  HqxStats stats;
+  hqxStats( stats );
+
+  static const char *names[4] = { "1/5", "5/7", "7/3", "3/1" };
+  std::cerr << "Stats: " << stats.pixels << " pixels" << std::endl;
+  for( int t=0; t<4; t++ ) {
+    std::cerr << "  test " << names[t] << ": " << stats.tests[t] << " run, "
+	      << stats.differences[t] << " different" << std::endl;
+  }
+  std::cerr << "  comparisons: " << stats.comparisons << ", equal colors: "
+	    << stats.equal << " ("
+	    << (stats.comparisons ? 100.0*stats.equal/stats.comparisons : 0.0)
+	    << "%)" << std::endl;
+
+  int order[256];
+  for( int k=0; k<256; k++ ) { order[k] = k; }
+  std::stable_sort( order, order+256, [&]( int a, int b ) {
+      return stats.patterns[a] > stats.patterns[b]; } );
+
+  uint64_t total = 0;
+  std::cerr << "  pattern     count       %   cum.%" << std::endl;
+  for( int k=0; k<256 && stats.patterns[order[k]] > 0; k++ ) {
+    uint64_t n = stats.patterns[order[k]];
+    total += n;
+    std::fprintf( stderr, "  %7d %9llu %7.3f %7.3f\n", order[k],
+		  (unsigned long long) n, 100.0*n/stats.pixels,
+		  100.0*total/stats.pixels );
+  }
+}
+
+// Images that the headers allow can still be too large for the memory at
+// hand; report that, rather than aborting.
+static void outOfMemory() {
+  std::cerr << "Out of memory" << std::endl;
+  std::exit( 1 );
 }
 
 // Takes 2 or 3 arguments: algo infile outfile
 // If only two args are present, output filename defaults to "output.bmp"
 // The first arg, giving the algo must be present and be one of:...
+// Options, if any, precede the positional arguments.
 int main(int argc, char **argv )
 {
   string algo = "";
   string infile = "";
   string outfile = "output.bmp";
+  bool timing = false;
+  bool streaming = false;
+  bool cache = false;
+  bool stats = false;
+  size_t memory = 0;
+
+  std::set_new_handler( outOfMemory );
+
+  int argi = 1;
+  while( argi < argc && string(argv[argi]).compare(0, 2, "--") == 0 ) {
+    string opt = argv[argi++];
+    if(      opt == "--timing" ) { timing = true; }
+    else if( opt == "--stream" ) { streaming = true; }
+    else if( opt == "--cache" )  { cache = true; setHqxCache( true ); }
+    else if( opt == "--buckets" ) { setHqxBuckets( true ); }
+    else if( opt == "--stats" ) {
+      if( !setHqxStats( true ) ) {
+	std::cerr << "--stats needs a build with HQX_STATS defined" << std::endl;
+	return 1;
+      }
+      stats = true;
+    }
+    else if( opt == "--xbr" && argi < argc ) {
+      string mode = argv[argi++];
+      if(      mode == "inplace" )  { setXbrMode( XBR_IN_PLACE ); }
+      else if( mode == "buffered" ) { setXbrMode( XBR_BUFFERED ); }
+      else if( mode == "tiled" )    { setXbrMode( XBR_TILED ); }
+      else if( mode == "fixed" )    { setXbrMode( XBR_FIXED ); }
+      else {
+	print_usage( 2 );
+	return 1;
+      }
+    }
+    else if( opt == "--memory" && argi < argc ) {
+      memory = (size_t) ( std::strtod( argv[argi++], NULL ) * (1 << 20) );
+    }
+    else if( opt == "--threads" && argi < argc ) {
+      setThreadCount( std::atoi( argv[argi++] ) );
+    }
+    else {
+      print_usage( 2 );
+      return 1;
+    }
+  }
+  argc -= argi-1;
+  argv += argi-1;
+
+  // Cache hits skip the pattern tests, so hqx leaves the cache off while
+  // counting
+  if( stats && cache ) {
+    std::cerr << "--cache is ignored with --stats" << std::endl;
+    cache = false;
+  }
   
-  // in, out = stdin, stdout  
+  // in, out = stdin, stdout, if given as "-"
   if( argc > 3 ) { outfile = argv[3]; }
   if( argc > 2 ) { infile = argv[2];  }
   
@@ -65,62 +234,129 @@ int main(int argc, char **argv )
     print_usage(0);
     return 0;
   }
+  if( infile == "-" && memory == 0 ) { streaming = true; }
 
-  uint32_t factor = 1;
-  uint16_t padding = 0;
-
-  if(      algo == "copy" )       { factor = 1; padding = 0; }
-  else if( algo == "block2" )     { factor = 2; padding = 0; }
-  else if( algo == "block3" )     { factor = 3; padding = 0; }  
-  else if( algo == "scale2x" )    { factor = 2; padding = 0; }
-  else if( algo == "scale2xPad" ) { factor = 2; padding = 1; }
-  else if( algo == "scale2xSFX" ) { factor = 2; padding = 2; }
-  else if( algo == "scale3x" )    { factor = 3; padding = 1; }
-  else if( algo == "scale3xSFX" ) { factor = 3; padding = 2; } 
-  else if( algo == "hq2xA" )      { factor = 2; padding = 0; }
-  else if( algo == "hq2xB" )      { factor = 2; padding = 0; }
-  else if( algo == "hq3xA" )      { factor = 3; padding = 0; }
-  else if( algo == "hq3xB" )      { factor = 3; padding = 0; }
-  else if( algo == "superXBR" )   { factor = 2; padding = 0; }  
-  else {
+  const Scaler *scaler = NULL;
+  for( size_t i = 0; i < sizeof(scalers)/sizeof(scalers[0]); i++ ) {
+    if( algo == scalers[i].name ) { scaler = &scalers[i]; }
+  }
+  if( scaler == NULL ) {
     print_usage( 1 );
     return 0;
-  }   
+  }
+  // The support of superXBR depends on how its passes run
+  Scaler chosen = *scaler;
+  if( chosen.scale == scaleSuperXBR ) { chosen.support = xbrSupport(); }
+  scaler = &chosen;
+
+  uint32_t factor = scaler->factor;
+  uint16_t padding = scaler->padding;
+
+  std::chrono::steady_clock::time_point start;
+
+  // Scale the image tile by tile, within the given memory budget
+  if( memory > 0 ) {
+    BitmapReader reader;
+    BitmapWriter writer;
+    start = std::chrono::steady_clock::now();
+    if( int res = reader.open( infile ) ) {
+      std::cerr << "Loading image failed " << res << std::endl;
+      return 1;
+    }
+    uint32_t width = reader.width(), height = reader.height();
+    if( writer.open( outfile, width*factor, height*factor ) != 0 ) {
+      std::cerr << "Saving image failed " << std::endl;
+      return 1;
+    }
+
+    std::cerr<<"Tiling now: "<<algo<<" "<<width<<"x"<<height<<std::endl;
+    if( int res = tiledScale( reader, writer, *scaler, memory ) ) {
+      if( res == -5 ) {
+	std::cerr << "Tiling needs regular input and output files" << std::endl;
+      } else if( res == -6 ) {
+	std::cerr << "Tiling is not supported for " << algo << std::endl;
+      } else if( res == -7 ) {
+	std::cerr << "Memory limit too small" << std::endl;
+      } else {
+	std::cerr << "Tiling image failed " << res << std::endl;
+      }
+      return 1;
+    }
+    if( writer.close() != 0 ) {
+      std::cerr << "Saving image failed " << std::endl;
+      return 1;
+    }
+    if( timing ) {
+      report( "Tiles", start, 3.0*width*factor*height*factor );
+    }
+    if( cache ) { reportCache(); }
+    if( stats ) { reportStats(); }
+    return 0;
+  }
+
+  // Stream the image through the scaler, band by band
+  if( streaming ) {
+    BitmapReader reader;
+    BitmapWriter writer;
+    start = std::chrono::steady_clock::now();
+    if( int res = reader.open( infile ) ) {
+      std::cerr << "Loading image failed " << res << std::endl;
+      return 1;
+    }
+    uint32_t width = reader.width(), height = reader.height();
+    if( writer.open( outfile, width*factor, height*factor ) != 0 ) {
+      std::cerr << "Saving image failed " << std::endl;
+      return 1;
+    }
+
+    std::cerr<<"Streaming now: "<<algo<<" "<<width<<"x"<<height<<std::endl;
+    if( int res = streamScale( reader, writer, *scaler ) ) {
+      std::cerr << "Streaming image failed " << res << std::endl;
+      return 1;
+    }
+    if( writer.close() != 0 ) {
+      std::cerr << "Saving image failed " << std::endl;
+      return 1;
+    }
+    if( timing ) {
+      report( "Stream", start, 3.0*width*factor*height*factor );
+      if( scaler->scale == scaleSuperXBR ) { reportTraffic(); }
+    }
+    if( cache ) { reportCache(); }
+    if( stats ) { reportStats(); }
+    return 0;
+  }
   
   // load the input image
-  uint16_t width, height;
+  uint32_t width, height;
   uint32_t *image = NULL;
+  start = std::chrono::steady_clock::now();
   if( int res = loadBitmapPadded(infile, image, width, height, padding) ) {
     std::cerr << "Loading image failed " << res << std::endl;
     return 1;
   }
+  if( timing ) { report( "Load", start, 3.0*width*height ); }
     
   // resize the input image using the given scale factor
-  uint32_t outputSize = (width * factor) * (height * factor);
+  size_t outputSize = (size_t) width*factor * height*factor;
   uint32_t *output = new uint32_t[outputSize]();
 
   std::cerr<<"Scaling now: "<<algo<<" "<<width<<"x"<<height<<std::endl;
-  if(      algo == "copy" )       { copy( image, width, height, output ); }	
-  else if( algo == "block2" )     { block2( image, width, height, output ); }	
-  else if( algo == "block3" )     { block3( image, width, height, output ); } 
-  else if( algo == "scale2x" )    { scale2x( image, width, height, output ); }
-  else if( algo == "scale2xPad" ) { scale2xPad( image, width, height, output );}
-  else if( algo == "scale2xSFX" ) { scale2xSFX( image, width, height, output );}
-  else if( algo == "scale3x" )    { scale3xPad( image, width, height, output );}
-  else if( algo == "scale3xSFX" ) { scale3xSFX( image, width, height, output );}
-  else if( algo == "hq2xA" )      { hq2xA( image, width, height, output ); }
-  else if( algo == "hq2xB" )      { hq2xB( image, width, height, output ); }
-  else if( algo == "hq3xA" )      { hq3xA( image, width, height, output ); }
-  else if( algo == "hq3xB" )      { hq3xB( image, width, height, output ); }
-  else if( algo == "superXBR" ) { scaleSuperXBR( image, width, height, output);}
-  else {
-    // should never happen...
+  start = std::chrono::steady_clock::now();
+  scaler->scale( image, width, height, output );
+  if( timing ) {
+    report( "Scale", start, 3.0*outputSize );
+    if( scaler->scale == scaleSuperXBR ) { reportTraffic(); }
   }
+  if( cache ) { reportCache(); }
+  if( stats ) { reportStats(); }
 
   // saves the resized image
+  start = std::chrono::steady_clock::now();
   if( saveBitmap(output, width*factor, height*factor, outfile) != 0 ) {
     std::cerr << "Saving image failed " << std::endl;
   }
+  if( timing ) { report( "Save", start, 3.0*outputSize ); }
 
   delete[] image;
   delete[] output;
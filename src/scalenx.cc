@@ -25,18 +25,22 @@ SOFTWARE.
 
 */		  
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 
 #include "scalenx.h"
+#include "threads.h"
 
 // Copies input to output, pixel by pixel. No scaling. Mostly for testing.
-void copy( uint32_t *img, int w, int h, uint32_t *out ) {
+static void copyRows( uint32_t *img, int w, uint32_t *out,
+		      int j0, int j1 ) {
   uint32_t *p = img;
   uint32_t *q = out;
   
-  for( int j=0; j<h; j++ ) {
-    p = img + j*w;
-    q = out + j*w;
+  for( int j=j0; j<j1; j++ ) {
+    p = img + (ptrdiff_t) j*w;
+    q = out + (ptrdiff_t) j*w;
     
     for( int i=0; i<w; i++ ) {
       q[i] = p[i];
@@ -44,14 +48,21 @@ void copy( uint32_t *img, int w, int h, uint32_t *out ) {
   }
 }
 
+void copy( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      copyRows( img, w, out, j0, j1 );
+    } );
+}
+
 // Expands every input pixel to a 2x2 block. No interpolation.
-void block2( uint32_t *img, int w, int h, uint32_t *out ) {
+static void block2Rows( uint32_t *img, int w, uint32_t *out,
+			int j0, int j1 ) {
   uint32_t *p = img;
   uint32_t *q = out;
   
-  for( int j=0; j<h; j++ ) {
-    p = img + j*w;   
-    q = out + 2*2*j*w;
+  for( int j=j0; j<j1; j++ ) {
+    p = img + (ptrdiff_t) j*w;
+    q = out + (ptrdiff_t) 2*2*j*w;
     
     for( int i=0; i<w; i++ ) {
       q[2*i] = p[i];
@@ -62,16 +73,23 @@ void block2( uint32_t *img, int w, int h, uint32_t *out ) {
   }
 }
 
+void block2( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      block2Rows( img, w, out, j0, j1 );
+    } );
+}
+
 // Expands every input pixel to a 3x3 block. No interpolation.
-void block3( uint32_t *img, int w, int h, uint32_t *out ) {
-  uint16_t scl = 3;  
+static void block3Rows( uint32_t *img, int w, uint32_t *out,
+			int j0, int j1 ) {
+  int scl = 3;  
 
-  uint32_t *p = img;
-  uint32_t *q1 = out;
+  uint32_t *p = img + (ptrdiff_t) j0*w;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*w;
   uint32_t *q2 = q1 + scl*w;
   uint32_t *q3 = q2 + scl*w;
   
-  for( int j=0; j<h; j++ ) {
+  for( int j=j0; j<j1; j++ ) {
     for( int i=0; i<w; i++ ) {
 
       for( int k=0; k<scl; k++ ) {
@@ -88,18 +106,25 @@ void block3( uint32_t *img, int w, int h, uint32_t *out ) {
   }
 }
 
+void block3( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      block3Rows( img, w, out, j0, j1 );
+    } );
+}
+
 // scale2x algo: http://www.scale2x.it/algorithm
 // This version handles boundaries and does not require padded input
-void scale2x( uint32_t *img, int W, int H, uint32_t *out ) {
-  uint16_t scl = 2;
+static void scale2xRows( uint32_t *img, int W, int H, uint32_t *out,
+			 int j0, int j1 ) {
+  int scl = 2;
   
-  uint32_t *p = img;
-  uint32_t *q1 = out;
-  uint32_t *q2 = out + scl*W;
+  uint32_t *p = img + (ptrdiff_t) j0*W;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*W;
+  uint32_t *q2 = q1 + scl*W;
 
   uint32_t b, d, e, f, h;
   
-  for( int j=0; j<H; j++ ) {    
+  for( int j=j0; j<j1; j++ ) {    
     for( int i=0; i<W; i++ ) {
       b = j>0 ? p[i-W] : p[i];
       d = i>0 ? p[i-1] : p[0];
@@ -124,19 +149,26 @@ void scale2x( uint32_t *img, int W, int H, uint32_t *out ) {
   }
 }
 
+void scale2x( uint32_t *img, int W, int H, uint32_t *out ) {
+  parallelFor( 0, H, [=]( int j0, int j1 ) {
+      scale2xRows( img, W, H, out, j0, j1 );
+    } );
+}
+
 // Same as scale2x, but requires a 1px padding on all four sides.
-void scale2xPad( uint32_t *img, uint16_t W, uint16_t H, uint32_t *out ) {
-  uint16_t scl = 2;
-  uint16_t pad = 1;
+static void scale2xPadRows( uint32_t *img, int W, uint32_t *out,
+			    int j0, int j1 ) {
+  int scl = 2;
+  int pad = 1;
   
-  uint16_t V = W+2*pad;
-  uint32_t *p = img + V + pad;
-  uint32_t *q1 = out;
-  uint32_t *q2 = out + scl*W;
+  int V = W+2*pad;
+  uint32_t *p = img + (ptrdiff_t) (pad+j0)*V + pad;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*W;
+  uint32_t *q2 = q1 + scl*W;
 
   uint32_t b, d, e, f, h;
   
-  for( int j=0; j<H; j++ ) {    
+  for( int j=j0; j<j1; j++ ) {    
     for( int i=0; i<W; i++ ) {
       b = p[i-V];
       d = p[i-1];
@@ -161,22 +193,29 @@ void scale2xPad( uint32_t *img, uint16_t W, uint16_t H, uint32_t *out ) {
   }
 }
 
+void scale2xPad( uint32_t *img, int W, int H, uint32_t *out ) {
+  parallelFor( 0, H, [=]( int j0, int j1 ) {
+      scale2xPadRows( img, W, out, j0, j1 );
+    } );
+}
+
 // Improved scale2x by Sp00kyFox. Impl requires 2px padding on all four sides. 
 // https://web.archive.org/web/20160527015550/https://libretro.com/forums/archive/index.php?t-1655.html
-void scale2xSFX( uint32_t *img, int w, int h, uint32_t *out ) {
-  uint16_t pad = 2;
-  uint16_t scl = 2;  
+static void scale2xSFXRows( uint32_t *img, int w, uint32_t *out,
+			    int j0, int j1 ) {
+  int pad = 2;
+  int scl = 2;  
 
-  uint16_t V = w + 2*pad;
+  int V = w + 2*pad;
 
-  uint32_t *p = img + pad*V + pad;
-  uint32_t *q1 = out;
-  uint32_t *q2 = out + scl*w;
+  uint32_t *p = img + (ptrdiff_t) (pad+j0)*V + pad;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*w;
+  uint32_t *q2 = q1 + scl*w;
   
   uint32_t A, B, C, D, E, F, G, H, I, J, K, L, M;
   uint32_t e0, e1, e2, e3;
   
-  for( int j=0; j<h; j++ ) {
+  for( int j=j0; j<j1; j++ ) {
     for( int i=0; i<w; i++ ) {
       J = p[i-2*V];
       
@@ -220,23 +259,30 @@ void scale2xSFX( uint32_t *img, int w, int h, uint32_t *out ) {
   }
 }
 
+void scale2xSFX( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      scale2xSFXRows( img, w, out, j0, j1 );
+    } );
+}
+
 
 // scale3x algo: http://www.scale2x.it/algorithm
 // Impl requires 1px padding on all four sides.
-void scale3xPad( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out ) {
-  uint16_t pad = 1;
-  uint16_t scl = 3;  
-  uint16_t V = w+2*pad;
+static void scale3xPadRows( uint32_t *img, int w, uint32_t *out,
+			    int j0, int j1 ) {
+  int pad = 1;
+  int scl = 3;  
+  int V = w+2*pad;
   
-  uint32_t *p = img + V + pad;
-  uint32_t *q1 = out;
+  uint32_t *p = img + (ptrdiff_t) (pad+j0)*V + pad;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*w;
   uint32_t *q2 = q1 + scl*w;
   uint32_t *q3 = q2 + scl*w;
 
   uint32_t A, B, C, D, E, F, G, H, I;
   uint32_t E0, E1, E2, E3, E4, E5, E6, E7, E8;
   
-  for( int j=0; j<h; j++ ) {    
+  for( int j=j0; j<j1; j++ ) {    
     for( int i=0; i<w; i++ ) {
       A = p[i-V-1];
       B = p[i-V];
@@ -292,22 +338,29 @@ void scale3xPad( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out ) {
   }
 }
 
+void scale3xPad( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      scale3xPadRows( img, w, out, j0, j1 );
+    } );
+}
+
 // Improved scale3x by Sp00kyFox. Impl requires 2px padding on all four sides. 
 // https://web.archive.org/web/20160527015550/https://libretro.com/forums/archive/index.php?t-1655.html
-void scale3xSFX( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out ) {
-  uint16_t pad = 2;
-  uint16_t scl = 3;  
-  uint16_t V = w+2*pad;
+static void scale3xSFXRows( uint32_t *img, int w, uint32_t *out,
+			    int j0, int j1 ) {
+  int pad = 2;
+  int scl = 3;  
+  int V = w+2*pad;
   
-  uint32_t *p = img + pad*V + pad;
-  uint32_t *q1 = out;
+  uint32_t *p = img + (ptrdiff_t) (pad+j0)*V + pad;
+  uint32_t *q1 = out + (ptrdiff_t) scl*scl*j0*w;
   uint32_t *q2 = q1 + scl*w;
   uint32_t *q3 = q2 + scl*w;
 
   uint32_t A, B, C, D, E, F, G, H, I, J, K, L, M;
   uint32_t E0, E1, E2, E3, E4, E5, E6, E7, E8;  
   
-  for( int j=0; j<h; j++ ) {
+  for( int j=j0; j<j1; j++ ) {
     for( int i=0; i<w; i++ ) {
       J = p[i-2*V];
       
@@ -358,3 +411,9 @@ void scale3xSFX( uint32_t *img, uint16_t w, uint16_t h, uint32_t *out ) {
     q3 += scl*scl*w;    
   }
 }
+
+void scale3xSFX( uint32_t *img, int w, int h, uint32_t *out ) {
+  parallelFor( 0, h, [=]( int j0, int j1 ) {
+      scale3xSFXRows( img, w, out, j0, j1 );
+    } );
+}
@@ -0,0 +1,123 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "bitmap.h"
+#include "stream.h"
+
+// Number of input rows scaled at a time
+static const int bandRows = 16;
+
+// Scales the image from reader in bands of rows, and passes each band's
+// output rows on to writer as soon as they are complete. Only the rows
+// that the current band depends on are kept in memory, so that memory use
+// grows with the width of the image, and with the support of the scaler,
+// but not with its height. Scalers with unlimited support still need the
+// whole image, which is then treated as a single band.
+//
+// Files store the bottom row first. Bands are therefore processed from the
+// bottom of the image upwards, and output rows are written in that order.
+// Each band is copied, along with the rows it depends on, into a window,
+// which is handed to the scaler as if it were a complete image:
+//
+// - Scalers that expect padding get the band plus the padding; rows and
+//   columns outside of the image repeat the nearest edge pixel, as they do
+//   for loadBitmapPadded(). The output is exactly that of the band.
+// - Other scalers get the band plus up to "support" rows on either side,
+//   as far as those exist. Those extra rows are taken for the edge of the
+//   image by the scaler, so their output is discarded.
+int streamScale( BitmapReader &reader, BitmapWriter &writer,
+		 const Scaler &scaler ) {
+  // All sizes below are ints, including those of the output
+  if( reader.width() > INT_MAX / scaler.factor ||
+      reader.height() > INT_MAX / scaler.factor ) {
+    return -5;
+  }
+
+  int w = reader.width();
+  int h = reader.height();
+  int f = scaler.factor;
+  int pad = scaler.padding;
+
+  int band = scaler.support < 0 ? h : bandRows;
+  int halo = scaler.support < 0 ? 0 : std::max( scaler.support, pad );
+
+  // Recently read rows, in a ring: image row y lives in slot y % ring.
+  // It holds the band and the halo on either side.
+  int ring = std::max( 1, std::min( h, band + 2*halo ) );
+  std::vector<uint32_t> rows( (size_t) ring * w );
+
+  int V = w + 2*pad;
+  size_t outW = (size_t) w * f;
+  std::vector<uint32_t> window( (size_t) V * (band + 2*halo) );
+  std::vector<uint32_t> out( outW * f * (band + 2*halo) );
+
+  int next = h; // rows [next, h) have been read
+  for( int j1 = h; j1 > 0; j1 -= band ) {
+    int j0 = std::max( 0, j1 - band );
+
+    for( int need = std::max( 0, j0 - halo ); next > need; ) {
+      next--;
+      if( int res = reader.readRow( &rows[(size_t) (next % ring) * w] ) ) {
+	return res;
+      }
+    }
+
+    // Rows in the window above and below the band
+    int top = pad > 0 ? pad : std::min( halo, j0 );
+    int bottom = pad > 0 ? pad : std::min( halo, h - j1 );
+    int count = top + (j1 - j0) + bottom;
+
+    for( int r = 0; r < count; r++ ) {
+      int y = std::min( std::max( j0 - top + r, 0 ), h - 1 );
+      const uint32_t *src = &rows[(size_t) (y % ring) * w];
+      uint32_t *dst = &window[(size_t) r * V];
+
+      std::fill( dst, dst + pad, src[0] );
+      std::copy( src, src + w, dst + pad );
+      std::fill( dst + pad + w, dst + V, src[w - 1] );
+    }
+
+    scaler.scale( window.data(), w, pad > 0 ? j1 - j0 : count, out.data() );
+
+    const uint32_t *first = out.data() + (pad > 0 ? 0 : top * f * outW);
+    for( int r = (j1 - j0) * f - 1; r >= 0; r-- ) {
+      if( int res = writer.writeRow( first + r * outW ) ) {
+	return res;
+      }
+    }
+    if( int res = writer.flush() ) {
+      return res;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Checks patternPlane() against the per-pixel 3x3 window loop of the
+// original hq2x_resize, for both modes, all four ways of wrapping, and
+// several sets of thresholds. Images are random, with colors drawn close
+// to each other so that the thresholds decide, and come in sizes around
+// the widths of the SIMD edge tests. Run once per level of
+// PIXELSCALER_SIMD (see "make test") to cover every edge test.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "cpu.h"
+#include "hqx1.h"
+#include "threads.h"
+
+// The pattern of every pixel, one 3x3 window at a time, as in the
+// original implementation: neighbours outside of the image wrap around,
+// or repeat the center row or column.
+static void referencePatterns( char mode, const uint32_t *image, int w, int h,
+			       uint32_t trY, uint32_t trU, uint32_t trV,
+			       uint32_t trA, bool wrapX, bool wrapY,
+			       uint8_t *patterns ) {
+  trY <<= 16;
+  trU <<= 8;
+  trA <<= 24;
+
+  for( int row = 0; row < h; row++ ) {
+    for( int col = 0; col < w; col++ ) {
+      uint32_t win[9];
+      for( int k = 0; k < 9; k++ ) {
+	int y = row + k/3 - 1, x = col + k%3 - 1;
+	if( y < 0 || y >= h ) { y = wrapY ? (y + h) % h : row; }
+	if( x < 0 || x >= w ) { x = wrapX ? (x + w) % w : col; }
+	win[k] = image[(size_t) y * w + x];
+      }
+
+      uint32_t center = ARGBtoAYUV( win[4] );
+      int pattern = 0;
+      for( int k = 0, flag = 1; k < 9; k++ ) {
+	if( k == 4 ) { continue; }
+	if( win[k] != win[4] ) {
+	  uint32_t other = ARGBtoAYUV( win[k] );
+	  bool different = mode == 'B' ?
+	    isDifferentB( center, other, trY, trU, trV, trA ) :
+	    isDifferentA( center, other, trY, trU, trV, trA );
+	  if( different ) { pattern |= flag; }
+	}
+	flag <<= 1;
+      }
+      patterns[(size_t) row * w + col] = pattern;
+    }
+  }
+}
+
+// A random image whose colors are a few steps apart in every channel
+// (alpha included), around one of a handful of base colors.
+static std::vector<uint32_t> randomImage( std::mt19937 &rng, int w, int h,
+					  int spread ) {
+  std::uniform_int_distribution<uint32_t> any;
+  std::uniform_int_distribution<int> step( -spread, spread );
+
+  uint32_t bases[4];
+  for( int k = 0; k < 4; k++ ) { bases[k] = any( rng ); }
+
+  std::vector<uint32_t> image( (size_t) w * h );
+  for( size_t i = 0; i < image.size(); i++ ) {
+    uint32_t base = bases[rng() % 4];
+    if( rng() % 4 == 0 ) {
+      image[i] = image[i > 0 ? i - 1 : 0];
+      continue;
+    }
+    uint32_t c = 0;
+    for( int s = 0; s < 32; s += 8 ) {
+      int v = (int) ((base >> s) & 0xFF) + step( rng );
+      c |= (uint32_t) (v & 0xFF) << s;
+    }
+    image[i] = c;
+  }
+  return image;
+}
+
+int main() {
+  static const char *levels[] = { "scalar", "ssse3", "avx2", "avx512" };
+  static const int widths[] = { 1, 2, 3, 7, 8, 9, 10, 15, 16, 17, 18, 31,
+				33, 64, 67 };
+  static const int heights[] = { 1, 2, 3, 4, 9 };
+  static const uint32_t thresholds[][4] = {
+    { 0x30, 0x07, 0x06, 0x50 },	// as used by the scalers
+    { 0, 0, 0, 0 },
+    { 1, 2, 3, 4 },
+    { 0xFF, 0xFF, 0xFF, 0xFF },
+    { 0x100, 0x200, 0x107, 0xFF },	// beyond a byte (trA must fit one)
+  };
+
+  std::mt19937 rng( 12345 );
+  setThreadCount( 3 );
+
+  int checks = 0, failures = 0;
+  for( int w : widths ) {
+    for( int h : heights ) {
+      for( int spread : { 2, 12, 128 } ) {
+	std::vector<uint32_t> image = randomImage( rng, w, h, spread );
+	std::vector<uint32_t> yuv( image.size() );
+	imageToAYUV( image.data(), w, h, yuv.data() );
+
+	for( const uint32_t *t : thresholds ) {
+	  for( char mode : { 'A', 'B' } ) {
+	    for( int wrap = 0; wrap < 4; wrap++ ) {
+	      bool wrapX = wrap & 1, wrapY = wrap & 2;
+	      std::vector<uint8_t> expected( image.size() ), actual( image.size() );
+
+	      referencePatterns( mode, image.data(), w, h, t[0], t[1], t[2], t[3],
+				 wrapX, wrapY, expected.data() );
+	      patternPlane( mode, image.data(), yuv.data(), w, h,
+			    t[0], t[1], t[2], t[3], wrapX, wrapY, actual.data() );
+
+	      checks++;
+	      for( size_t i = 0; i < image.size(); i++ ) {
+		if( actual[i] != expected[i] ) {
+		  std::fprintf( stderr, "%dx%d mode %c wrap %d%d thresholds "
+				"%x/%x/%x/%x: pixel (%d, %d) has pattern %d, "
+				"expected %d\n", w, h, mode, wrapX, wrapY,
+				t[0], t[1], t[2], t[3], (int) (i % w),
+				(int) (i / w), actual[i], expected[i] );
+		  failures++;
+		  break;
+		}
+	      }
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  std::printf( "patterns (%s): %d of %d checks failed\n",
+	       levels[cpuLevel()], failures, checks );
+  return failures > 0 ? 1 : 0;
+}
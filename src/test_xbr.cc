@@ -0,0 +1,242 @@
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Checks that the AVX2 passes of Super-xBR give exactly the output of the
+// scalar ones, in every mode (the in-place mode included), on images with
+// widths that are not a multiple of the 8 or 16 pixels of a vector step,
+// and on images too small for the AVX2 passes to run at all. The image
+// is scaled twice per mode, once with and once without AVX2, by
+// scaleSuperXBRT itself, which is why this file includes xbr.cc.
+//
+// Also checks the bound on the error of XBR_FIXED (see xbr.cc): for a
+// window of samples, its edge test agrees with the float one but at ties,
+// and where it agrees, no channel is off by more than 1; and over whole
+// images, where these differences propagate from pass to pass, few
+// channels drift from XBR_BUFFERED by more than 1.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "xbr.cc"
+
+// A random image: noise, a few colors in random blocks (as in pixel art,
+// with plenty of edges), or a gradient with some noise on top.
+static std::vector<uint32_t> randomImage( std::mt19937 &rng, int w, int h,
+					  int kind ) {
+  std::uniform_int_distribution<uint32_t> any;
+  uint32_t colors[4];
+  for( int k = 0; k < 4; k++ ) { colors[k] = any( rng ); }
+
+  std::vector<uint32_t> image( (size_t) w * h );
+  for( int y = 0; y < h; y++ ) {
+    for( int x = 0; x < w; x++ ) {
+      uint32_t &c = image[(size_t) y * w + x];
+      if( kind == 0 ) {
+	c = any( rng );
+      } else if( kind == 1 ) {
+	c = (x % 3 == 0 || y % 2 == 0 || rng() % 4 == 0) ?
+	  colors[rng() % 4] : image[(size_t) y * w + x - 1];
+      } else {
+	uint32_t v = (x * 255 / w + y * 255 / h) / 2 + rng() % 8;
+	c = 0xFF000000 | (v << 16) | ((255 - v) << 8) | (v / 2);
+      }
+    }
+  }
+  return image;
+}
+
+// The colors of a window: random, a few colors, grays, or one color plus
+// the same step in every channel (which is where ties come from).
+static uint32_t randomSample( std::mt19937 &rng, int kind, uint32_t base ) {
+  uint32_t v = rng() % 256, d = rng() % 4;
+  switch( kind ) {
+  case 0: return rng();
+  case 1: return 0xFF000000 | (rng() % 3) * 0x7F3F1F;
+  case 2: return 0xFF000000 | v * 0x010101;
+  default: return base + d * 0x010101;
+  }
+}
+
+// Scales windows with both arithmetics, for the weights of either pass,
+// and returns the number of windows that break the bound; flips counts
+// the edge tests that differ (at ties).
+static int checkWindows( std::mt19937 &rng, int count, int &flips ) {
+  int failures = 0;
+  size_t idx[4][4];
+  for( int k = 0; k < 16; k++ ) { idx[k / 4][k % 4] = k; }
+
+  for( int n = 0; n < count; n++ ) {
+    XbrPlanes p( 16 );
+    XbrFixedPlanes q( 16 );
+    int kind = n % 4;
+    uint32_t base = rng() & 0xFFFCFCFC;
+    for( int k = 0; k < 16; k++ ) {
+      uint32_t c = randomSample( rng, kind, base );
+      p.set( k, c );
+      q.set( k, c );
+    }
+
+    // a tie: two luminances a whole number apart (in float, the difference
+    // may then be just below it)
+    bool tie = false;
+    for( int a = 0; a < 16; a++ ) {
+      for( int b = 0; b < 16; b++ ) {
+	int d = q.Y[a] - q.Y[b];
+	if( d != 0 && d % 10000 == 0 ) { tie = true; }
+      }
+    }
+
+    XbrWindow s( p, idx );
+    XbrFixedWindow t( q, idx );
+    for( int pass = 0; pass < 2; pass++ ) {
+      float *wp = pass ? xbrWeights2 : xbrWeights;
+      const int *wq = pass ? xbrFixedWeights2 : xbrFixedWeights;
+      bool edge = diagonal_edge( s.Y, wp ) <= 0;
+      bool fixedEdge = xbrFixedEdge( t.Y, wq ) <= 0;
+      u32 expected = pass ? xbrPixel( s, XbrRange( s ), wp, w3, w4 ) :
+	xbrPixel( s, XbrRange( s ), wp, w1, w2 );
+      u32 actual = pass ? xbrFixedPixel( t, XbrFixedRange( t ), wq, fw3, fw4 ) :
+	xbrFixedPixel( t, XbrFixedRange( t ), wq, fw1, fw2 );
+
+      if( edge != fixedEdge ) {
+	flips++;
+	if( tie ) { continue; }
+	std::fprintf( stderr, "window %d pass %d: the edge test flips, "
+		      "without a tie\n", n, pass );
+	failures++;
+	continue;
+      }
+      for( int sh = 0; sh < 32; sh += 8 ) {
+	int d = (int) ((actual >> sh) & 0xFF) - (int) ((expected >> sh) & 0xFF);
+	if( d < -1 || d > 1 ) {
+	  std::fprintf( stderr, "window %d pass %d: %08x in fixed point, "
+			"%08x in float\n", n, pass, actual, expected );
+	  failures++;
+	  break;
+	}
+      }
+    }
+  }
+  return failures;
+}
+
+// The share of channels that differ by more than 1 between XBR_FIXED and
+// XBR_BUFFERED, for an image scaled by both.
+static double drift( const std::vector<uint32_t> &image, int w, int h,
+		     bool avx2 ) {
+  std::vector<uint32_t> fixed( (size_t) 4 * w * h ), buffered( fixed.size() );
+  std::vector<uint32_t> input( image );
+  setXbrMode( XBR_FIXED );
+  scaleSuperXBRT<2>( input.data(), fixed.data(), w, h, avx2 );
+  input = image;
+  setXbrMode( XBR_BUFFERED );
+  scaleSuperXBRT<2>( input.data(), buffered.data(), w, h, avx2 );
+
+  size_t off = 0;
+  for( size_t i = 0; i < fixed.size(); i++ ) {
+    for( int sh = 0; sh < 32; sh += 8 ) {
+      int d = (int) ((fixed[i] >> sh) & 0xFF) - (int) ((buffered[i] >> sh) & 0xFF);
+      if( d < -1 || d > 1 ) { off++; }
+    }
+  }
+  return (double) off / (4 * fixed.size());
+}
+
+int main() {
+  static const char *levels[] = { "scalar", "ssse3", "avx2", "avx512" };
+  static const char *modes[] = { "inplace", "buffered", "tiled", "fixed" };
+  static const int widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 23,
+				33, 70 };
+  static const int heights[] = { 1, 2, 3, 4, 5, 9, 17, 67 };
+
+  std::mt19937 rng( 12345 );
+  setThreadCount( 3 );
+
+  // The bound of XBR_FIXED, window by window, and over images
+  const int windows = 400000;
+  int flips = 0;
+  int fixedFailures = checkWindows( rng, windows, flips );
+  int fixedChecks = 2 * windows;
+  double worst = 0;
+  for( int kind = 0; kind < 3; kind++ ) {
+    std::vector<uint32_t> image = randomImage( rng, 160, 120, kind );
+    double d = drift( image, 160, 120, cpuLevel() >= CPU_AVX2 );
+    worst = std::max( worst, d );
+    fixedChecks++;
+    if( d > 0.01 ) {
+      std::fprintf( stderr, "image %d: %.2f%% of the channels drift by more "
+		    "than 1\n", kind, 100 * d );
+      fixedFailures++;
+    }
+  }
+  std::printf( "xbr fixed: %d of %d checks failed (%.4f%% of the edge tests "
+	       "flip, at most %.2f%% of the channels drift)\n", fixedFailures,
+	       fixedChecks, 100.0 * flips / (2 * windows), 100 * worst );
+
+  if( cpuLevel() < CPU_AVX2 ) {
+    std::printf( "xbr (%s): skipped, the AVX2 passes are not available\n",
+		 levels[cpuLevel()] );
+    return fixedFailures > 0 ? 1 : 0;
+  }
+
+  int checks = 0, failures = 0;
+  for( int w : widths ) {
+    for( int h : heights ) {
+      for( int kind = 0; kind < 3; kind++ ) {
+	std::vector<uint32_t> image = randomImage( rng, w, h, kind );
+
+	for( int mode = XBR_IN_PLACE; mode <= XBR_FIXED; mode++ ) {
+	  std::vector<uint32_t> expected( (size_t) 4 * w * h );
+	  std::vector<uint32_t> actual( expected.size() );
+	  std::vector<uint32_t> input( image );
+
+	  setXbrMode( (XbrMode) mode );
+	  scaleSuperXBRT<2>( input.data(), expected.data(), w, h, false );
+	  input = image;
+	  scaleSuperXBRT<2>( input.data(), actual.data(), w, h, true );
+
+	  checks++;
+	  for( size_t i = 0; i < expected.size(); i++ ) {
+	    if( actual[i] != expected[i] ) {
+	      std::fprintf( stderr, "%dx%d image %d mode %s: pixel (%d, %d) "
+			    "is %08x with AVX2, %08x without\n", w, h, kind,
+			    modes[mode], (int) (i % (2*w)), (int) (i / (2*w)),
+			    actual[i], expected[i] );
+	      failures++;
+	      break;
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  std::printf( "xbr (%s): %d of %d checks failed\n",
+	       levels[cpuLevel()], failures, checks );
+  return failures + fixedFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "threads.h"
+
+// Chunks per thread: more than one, so that threads finishing early can
+// pick up work left over by slower ones.
+static const int chunksPerThread = 4;
+
+namespace {
+
+// The workers sleep until the generation changes, then take chunks from the
+// current job until none are left.
+struct Pool {
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  unsigned generation = 0;
+  bool quit = false;
+
+  const std::function<void(int, int)> *fn = nullptr;
+  int begin = 0, end = 0, chunks = 0;
+  std::atomic<int> next{0};
+  int busy = 0;
+
+  ~Pool() { stop(); }
+
+  void start( int n );
+  void stop();
+  void work();
+  void runChunks();
+};
+
+}
+
+static Pool pool;
+static int threads = 1;
+static thread_local bool inside = false;
+
+void Pool::start( int n ) {
+  for( int i = 0; i < n; i++ ) {
+    workers.emplace_back( &Pool::work, this );
+  }
+}
+
+void Pool::stop() {
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    quit = true;
+  }
+  wake.notify_all();
+  for( size_t i = 0; i < workers.size(); i++ ) {
+    workers[i].join();
+  }
+  workers.clear();
+  quit = false;
+}
+
+void Pool::runChunks() {
+  int n = end - begin;
+  for( int k = next++; k < chunks; k = next++ ) {
+    (*fn)( begin + (int) ((long long) k*n/chunks),
+	   begin + (int) ((long long) (k+1)*n/chunks) );
+  }
+}
+
+void Pool::work() {
+  inside = true;
+  unsigned seen = 0;
+  for( ;; ) {
+    {
+      std::unique_lock<std::mutex> lock( mutex );
+      wake.wait( lock, [&] { return quit || generation != seen; } );
+      if( quit ) { return; }
+      seen = generation;
+    }
+
+    runChunks();
+
+    std::lock_guard<std::mutex> lock( mutex );
+    if( --busy == 0 ) { done.notify_one(); }
+  }
+}
+
+void setThreadCount( int n ) {
+  if( n <= 0 ) {
+    n = std::max( 1, (int) std::thread::hardware_concurrency() );
+  }
+  if( n == threads ) { return; }
+
+  pool.stop();
+  pool.start( n - 1 );
+  threads = n;
+}
+
+int threadCount() {
+  return threads;
+}
+
+void parallelFor( int begin, int end, const std::function<void(int, int)> &fn ) {
+  if( end <= begin ) { return; }
+
+  if( threads == 1 || inside || end - begin == 1 ) {
+    fn( begin, end );
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( pool.mutex );
+    pool.fn = &fn;
+    pool.begin = begin;
+    pool.end = end;
+    pool.chunks = std::min( end - begin, chunksPerThread*threads );
+    pool.next = 0;
+    pool.busy = (int) pool.workers.size();
+    pool.generation++;
+  }
+  pool.wake.notify_all();
+
+  inside = true;
+  pool.runChunks();
+  inside = false;
+
+  std::unique_lock<std::mutex> lock( pool.mutex );
+  pool.done.wait( lock, [] { return pool.busy == 0; } );
+}
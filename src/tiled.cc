@@ -0,0 +1,138 @@
+
+/*
+
+MIT License
+
+Copyright (c) 2022 Philipp K. Janert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/		  
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitmap.h"
+#include "stream.h"
+#include "tiled.h"
+
+// Bytes needed to scale a tile of tw x th input pixels, with a halo of e
+// pixels all around. The window is counted twice, to leave room for the
+// scaler's own per-pixel working data.
+static uint64_t tileBytes( uint64_t tw, uint64_t th, uint64_t e, uint64_t f ) {
+  return 8*(tw + 2*e)*(th + 2*e) + 4*f*f*tw*th;
+}
+
+// Scales the image in rectangular tiles, so that images can be processed
+// whose size exceeds the available memory. Tiles are read from the
+// memory-mapped input file and written straight to their place in the
+// output file, so both must be regular files. The tile size is chosen so
+// that a tile, its halo, and its output fit into memoryLimit bytes: tiles
+// span the full width of the image if possible, and are square otherwise.
+//
+// Like the streaming driver, each tile is extended by a halo of support
+// (or padding) pixels on all four sides, and handed to the scaler as if it
+// were a complete image. This relies on the neighbourhoods of all scalers
+// being as wide as they are high. Scalers with unlimited support cannot
+// be tiled.
+int tiledScale( BitmapReader &reader, BitmapWriter &writer,
+		const Scaler &scaler, size_t memoryLimit ) {
+  if( scaler.support < 0 ) {
+    return -6;
+  }
+
+  int64_t w = reader.width();
+  int64_t h = reader.height();
+  int64_t f = scaler.factor;
+  int64_t pad = scaler.padding;
+  int64_t e = std::max( (int64_t) scaler.support, pad );
+
+  // Full-width stripes, if at least a few rows fit; square tiles otherwise
+  int64_t tw = w, th = 0;
+  while( th < h && tileBytes( tw, th + 1, e, f ) <= memoryLimit ) {
+    th++;
+  }
+  if( th < std::min( h, 4*e + 1 ) ) {
+    int64_t t = 1;
+    while( t < std::max( w, h ) && tileBytes( 2*t, 2*t, e, f ) <= memoryLimit ) {
+      t *= 2;
+    }
+    while( t < std::max( w, h ) && tileBytes( t + 1, t + 1, e, f ) <= memoryLimit ) {
+      t++;
+    }
+    tw = std::min( t, w );
+    th = std::min( t, h );
+  }
+  if( w > 0 && h > 0 && tileBytes( tw, th, e, f ) > memoryLimit ) {
+    return -7;
+  }
+
+  std::vector<uint32_t> window( (size_t) (tw + 2*e) * (th + 2*e) );
+  std::vector<uint32_t> out( (size_t) f*f * (tw + 2*e) * (th + 2*e) );
+
+  for( int64_t y0 = 0; y0 < h; y0 += th ) {
+    for( int64_t x0 = 0; x0 < w; x0 += tw ) {
+      int64_t y1 = std::min( h, y0 + th );
+      int64_t x1 = std::min( w, x0 + tw );
+
+      // Halo on each side: the padding, or whatever support exists
+      int64_t top    = pad > 0 ? pad : std::min( e, y0 );
+      int64_t bottom = pad > 0 ? pad : std::min( e, h - y1 );
+      int64_t left   = pad > 0 ? pad : std::min( e, x0 );
+      int64_t right  = pad > 0 ? pad : std::min( e, w - x1 );
+
+      int64_t ww = left + (x1 - x0) + right;
+      int64_t wh = top + (y1 - y0) + bottom;
+
+      // Columns of the window that lie inside of the image
+      int64_t c0 = std::max( (int64_t) 0, x0 - left );
+      int64_t c1 = std::min( w, x1 + right );
+
+      for( int64_t r = 0; r < wh; r++ ) {
+	int64_t y = std::min( std::max( y0 - top + r, (int64_t) 0 ), h - 1 );
+	uint32_t *dst = &window[r * ww];
+	uint32_t *in = dst + (c0 - (x0 - left));
+
+	if( int res = reader.readSpan( y, c0, c1 - c0, in ) ) {
+	  return res;
+	}
+	std::fill( dst, in, in[0] );
+	std::fill( in + (c1 - c0), dst + ww, in[c1 - c0 - 1] );
+      }
+
+      int kw = pad > 0 ? x1 - x0 : ww;
+      int kh = pad > 0 ? y1 - y0 : wh;
+      scaler.scale( window.data(), kw, kh, out.data() );
+
+      // Crop the output for the halo, if any, and write it out
+      int64_t ow = kw * f;
+      const uint32_t *first = out.data() + (pad > 0 ? 0 : top*f*ow + left*f);
+      for( int64_t r = 0; r < (y1 - y0)*f; r++ ) {
+	if( int res = writer.writeSpan( y0*f + r, x0*f, (x1 - x0)*f,
+					first + r*ow ) ) {
+	  return res;
+	}
+      }
+    }
+  }
+
+  return 0;
+}